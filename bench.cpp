@@ -0,0 +1,366 @@
+#include "badgecpp/alloc_stats.hpp"
+#include "badgecpp/b64.hpp"
+#include "badgecpp/badge.hpp"
+#include "badgecpp/batch.hpp"
+#include "badgecpp/font.hpp"
+#include "badgecpp/icons.hpp"
+#include "badgecpp/util.hpp"
+#include "badgecpp/version.hpp"
+#include "badgecpp/xml.hpp"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+/// @brief 统计堆分配, 用于计算 allocs/op 与 bytes/op
+BADGECPP_COUNTING_OPERATOR_NEW();
+
+namespace {
+    /// @brief 阻止编译器把被测结果当作无用值优化掉
+    template<typename T>
+    void keep(const T &value) {
+#if defined(__GNUC__) || defined(__clang__)
+        asm volatile("" : : "r"(&value) : "memory");
+#else
+        static const void *volatile sink;
+        sink = &value;
+#endif
+    }
+
+    struct Result {
+        std::string name;
+        size_t iterations;
+        double ns_per_op;
+        std::optional<double> allocs_per_op;///< 未统计时为空
+        std::optional<double> bytes_per_op; ///< 未统计时为空
+    };
+
+    struct Options {
+        double min_time = 0.2;          ///< 每项至少运行的秒数
+        std::string filter;             ///< 只运行名字包含此子串的项
+        std::optional<std::string> json;///< JSON 输出路径, "-" 为标准输出
+    };
+
+    class Suite final {
+    public:
+        explicit Suite(Options options) : options_(std::move(options)) {}
+
+        /// @brief 运行一项基准: 先预热一次, 再倍增迭代次数直到耗时超过 min_time
+        /// @param count_allocs 是否统计堆分配; alloc_stats 只统计调用线程, op 在其他线程上分配时应传 false
+        template<typename F>
+        void run(std::string name, F &&op, bool count_allocs = true) {
+            if (!options_.filter.empty() && name.find(options_.filter) == std::string::npos) return;
+            op();
+            using clock = std::chrono::steady_clock;
+            for (size_t iterations = 1;; iterations *= 2) {
+                badge::alloc_stats::Scope scope;
+                const auto begin = clock::now();
+                for (size_t i = 0; i < iterations; ++i) op();
+                const double elapsed = std::chrono::duration<double>(clock::now() - begin).count();
+                if (elapsed < options_.min_time && iterations < (size_t{1} << 40)) continue;
+
+                const auto n = static_cast<double>(iterations);
+                auto &r = results_.emplace_back(Result{std::move(name), iterations, elapsed * 1e9 / n, std::nullopt, std::nullopt});
+                if (count_allocs) {
+                    const auto allocs = scope.report();
+                    r.allocs_per_op = static_cast<double>(allocs.allocations) / n;
+                    r.bytes_per_op = static_cast<double>(allocs.bytes) / n;
+                }
+                auto &os = log();
+                os << std::left << std::setw(48) << r.name << std::right << std::fixed
+                   << std::setprecision(1) << std::setw(12) << r.ns_per_op << " ns/op";
+                if (count_allocs) {
+                    os << std::setprecision(2) << std::setw(10) << *r.allocs_per_op << " allocs/op"
+                       << std::setprecision(1) << std::setw(12) << *r.bytes_per_op << " B/op";
+                } else {
+                    os << std::setw(10) << '-' << " allocs/op" << std::setw(12) << '-' << " B/op";
+                }
+                os << std::endl;
+                return;
+            }
+        }
+
+        /// @brief 输出 JSON, 便于对比两次运行的结果
+        void writeJson(std::ostream &out) const {
+            out << "{\n  \"context\": {\"library\": \"badgecpp\", \"version\": \"" << (badge::version::string() ? badge::version::string() : "")
+                << "\", \"build_type\": \"" << (badge::version::build_type() ? badge::version::build_type() : "")
+                << "\", \"min_time\": " << options_.min_time << "},\n  \"benchmarks\": [";
+            out << std::setprecision(17);
+            for (size_t i = 0; i < results_.size(); ++i) {
+                const auto &r = results_[i];
+                out << (i ? ",\n" : "\n") << "    {\"name\": \"" << r.name << "\", \"iterations\": " << r.iterations
+                    << ", \"ns_per_op\": " << r.ns_per_op;
+                if (r.allocs_per_op) out << ", \"allocs_per_op\": " << *r.allocs_per_op << ", \"bytes_per_op\": " << *r.bytes_per_op;
+                out << "}";
+            }
+            out << "\n  ]\n}\n";
+        }
+
+        /// @brief 表格输出: JSON 写到标准输出时改写到标准错误, 避免混在一起
+        [[nodiscard]] std::ostream &log() const { return options_.json == "-" ? std::cerr : std::cout; }
+
+    private:
+        Options options_;
+        std::vector<Result> results_;
+    };
+
+    struct Label {
+        std::string_view name;
+        std::string label, message;
+    };
+
+    const Label LABELS[] = {
+            {"ascii", "build", "passing"},
+            {"cjk", "构建状态", "通过"},
+            {"long", "continuous integration pipeline for the main branch", "passing with 1234 tests and 56 benchmarks in 7 minutes"},
+    };
+    constexpr badge::Style STYLES[] = {badge::FLAT, badge::FLAT_SQUARE, badge::PLASTIC, badge::FOR_THE_BADGE, badge::SOCIAL};
+
+    void benchBadges(Suite &suite) {
+        using namespace badge;
+        const auto logo = BuiltinIcons::by_title("C++");
+        for (const auto style: STYLES) {
+            for (const auto &[label_name, label, message]: LABELS) {
+                for (const bool with_logo: {false, true}) {
+                    const Badge badge{label, Color{"#08c"}, message, std::nullopt, style,
+                                      with_logo ? logo : nullptr, std::nullopt, std::nullopt, "bench"};
+                    std::string out;
+                    out.reserve(1 << 16);
+                    std::ostringstream name;
+                    name << "makeBadge/" << style_str(style) << '/' << label_name << (with_logo ? "/logo" : "/nologo");
+                    suite.run(name.str(), [&] {
+                        out.clear();
+                        badge.makeBadge(out);
+                        keep(out);
+                    });
+                }
+            }
+        }
+    }
+
+    /// @brief 批量渲染的吞吐量: 线程数从1倍增到 hardware_concurrency, 每次渲染 BATCH_SIZE 个徽章
+    /// @details 多线程时分配发生在工作线程上, 不统计分配列
+    void benchBatch(Suite &suite) {
+        using namespace badge;
+        constexpr size_t BATCH_SIZE = 1024;
+        const auto logo = BuiltinIcons::by_title("C++");
+        std::vector<Badge> badges;
+        badges.reserve(BATCH_SIZE);
+        for (size_t i = 0; i < BATCH_SIZE; ++i) {
+            const auto &[label_name, label, message] = LABELS[i % std::size(LABELS)];
+            badges.push_back({label, std::nullopt, message + std::to_string(i), std::nullopt, STYLES[i % std::size(STYLES)],
+                              i % 2 ? logo : nullptr, std::nullopt, std::nullopt, std::to_string(i)});
+        }
+        const unsigned int max_threads = std::max(std::thread::hardware_concurrency(), 1u);
+        for (unsigned int threads = 1;; threads = std::min(threads * 2, max_threads)) {
+            suite.run("renderBatch/" + std::to_string(BATCH_SIZE) + "/threads=" + std::to_string(threads), [&] {
+                const auto output = renderBatch(badges, {threads, 64});
+                keep(output);
+            }, threads == 1);
+            if (threads == max_threads) break;
+        }
+    }
+
+    void benchXml(Suite &suite) {
+        using namespace badge;
+        const auto logo = BuiltinIcons::by_title("C++");
+        for (const auto style: STYLES) {
+            const Badge badge{"build", std::nullopt, "passing", std::nullopt, style, logo, std::nullopt, std::nullopt, "bench"};
+            const Xml xml = badge.makeBadgeXml();
+            suite.run(std::string{"Xml::render/"} + style_str(style), [&] {
+                const auto svg = xml.render();
+                keep(svg);
+            });
+        }
+    }
+
+    void benchFont(Suite &suite) {
+        // 全部内置字体, 每种字体分别测 ASCII, CJK (回退到猜测宽度) 与长文本
+        constexpr std::string_view FONTS[] = {"verdana-11px-normal", "verdana-10px-normal", "verdana-10px-bold", "helvetica-11px-bold"};
+        for (const auto font_name: FONTS) {
+            const badge::Font *font = badge::Fonts::get(font_name);
+            for (const auto &[label_name, label, message]: LABELS) {
+                const std::string_view text = label;
+                suite.run("Font::widthOfString/" + std::string{font_name} + "/" + std::string{label_name}, [&] {
+                    const double width = font->widthOfString(text);
+                    keep(width);
+                });
+            }
+        }
+    }
+
+    void benchNumber(Suite &suite) {
+        // 渲染时的坐标与宽度: 整数, 一位小数, 需要四舍五入的值
+        const std::pair<std::string_view, double> values[] = {
+                {"integer", 120.0},
+                {"half", 345.5},
+                {"round", 71.23456},
+        };
+        for (const auto &[kind, number]: values) {
+            const double value = number;
+            suite.run("dtos/" + std::string{kind}, [&] {
+                const auto str = badge::dtos(value);
+                keep(str);
+            });
+            suite.run("NumberString::trimmed/" + std::string{kind}, [&] {
+                const auto str = badge::NumberString::trimmed(value);
+                keep(str.view());
+            });
+        }
+        suite.run("NumberString/unsigned", [] {
+            const badge::NumberString str{1234u};
+            keep(str.view());
+        });
+    }
+
+    void benchColor(Suite &suite) {
+        const std::pair<std::string_view, std::string_view> inputs[] = {
+                {"hex3", "#4c1"},
+                {"hex6", "#44cc11"},
+                {"rgb", "rgb(68, 204, 17)"},
+                {"rgba", "rgba(68, 204, 17, 0.5)"},
+                {"hsl", "hsl(103, 85%, 43%)"},
+                {"hsla", "hsla(103, 85%, 43%, 0.5)"},
+                {"named", "lightgoldenrodyellow"},
+                {"current", "currentColor"},
+                {"invalid", "rgb(68, 204"},
+                {"invalid-hex8", "#44cc1180"},
+        };
+        for (const auto &[syntax, css]: inputs) {
+            const std::string_view input = css;
+            suite.run("Color::parseString/" + std::string{syntax}, [&] {
+                std::array<uint8_t, 4> value{0, 0, 0, 255};
+                const bool ok = badge::Color::parseString(input, value);
+                keep(ok);
+                keep(value);
+            });
+        }
+    }
+
+    void benchB64(Suite &suite) {
+        for (const size_t size: {64, 1024, 16384}) {
+            std::vector<uint8_t> data(size);
+            for (size_t i = 0; i < size; ++i) data[i] = static_cast<uint8_t>(i * 131 + 7);
+            std::string buffer(badge::b64::encoded_size(size), '\0');
+            suite.run("b64encode/string/" + std::to_string(size), [&] {
+                const auto encoded = badge::b64::b64encode(data.data(), static_cast<uint32_t>(data.size()));
+                keep(encoded);
+            });
+            suite.run("b64encode/buffer/" + std::to_string(size), [&] {
+                const size_t written = badge::b64::b64encode(data.data(), data.size(), buffer.data());
+                keep(written);
+                keep(buffer);
+            });
+            const std::string encoded = badge::b64::b64encode(data.data(), static_cast<uint32_t>(data.size()));
+            suite.run("b64decode/" + std::to_string(size), [&] {
+                const auto decoded = badge::b64::b64decode(encoded);
+                keep(decoded);
+            });
+        }
+
+        // 每次操作编码全部内置图标的svg, 与渲染带logo的徽章时的编码相同
+        const auto &icons = badge::BuiltinIcons::icons();
+        size_t max_size = 0;
+        for (const auto &icon: icons) max_size = std::max(max_size, icon->icon.size());
+        std::string buffer(badge::b64::encoded_size(max_size), '\0');
+        suite.run("b64encode/icons/string", [&] {
+            for (const auto &icon: icons) {
+                const auto encoded = badge::b64::b64encode(reinterpret_cast<const uint8_t *>(icon->icon.data()), static_cast<uint32_t>(icon->icon.size()));
+                keep(encoded);
+            }
+        });
+        suite.run("b64encode/icons/buffer", [&] {
+            for (const auto &icon: icons) {
+                const size_t written = badge::b64::b64encode(reinterpret_cast<const uint8_t *>(icon->icon.data()), icon->icon.size(), buffer.data());
+                keep(written);
+                keep(buffer);
+            }
+        });
+    }
+
+    void benchIcons(Suite &suite) {
+        const std::pair<std::string_view, std::string_view> titles[] = {
+                {"hit", "C++"},
+                {"miss", "no such icon"},
+        };
+        for (const auto &[kind, name]: titles) {
+            const std::string_view title = name;
+            suite.run("BuiltinIcons::by_title/" + std::string{kind}, [&] {
+                const auto icon = badge::BuiltinIcons::by_title(title);
+                keep(icon);
+            });
+        }
+        // 目标延迟 (Release, 单线程): 哈希查找 < 200ns, 前缀补全 < 5us, 模糊查找 < 100us (完整的 simple-icons 图标集)
+        suite.run("BuiltinIcons::by_slug/hit", [] {// < 200ns
+            const auto icon = badge::BuiltinIcons::by_slug("cplusplus");
+            keep(icon);
+        });
+        suite.run("BuiltinIcons::by_slug/miss", [] {// < 200ns
+            const auto icon = badge::BuiltinIcons::by_slug("nosuchicon");
+            keep(icon);
+        });
+        suite.run("BuiltinIcons::lookup/nocase", [] {// < 200ns, 依次查标题, slug, 小写标题
+            const auto icon = badge::BuiltinIcons::lookup("c++");
+            keep(icon);
+        });
+        suite.run("BuiltinIcons::complete/py", [] {// < 5us
+            const auto icons = badge::BuiltinIcons::complete("py", 10);
+            keep(icons);
+        });
+        suite.run("BuiltinIcons::suggest/pyhton", [] {// < 100us
+            const auto icons = badge::BuiltinIcons::suggest("pyhton");
+            keep(icons);
+        });
+    }
+
+    int usage(const char *argv0) {
+        std::cerr << "usage: " << argv0 << " [--filter SUBSTR] [--min-time SECONDS] [--json FILE|-]" << std::endl;
+        return 2;
+    }
+}// namespace
+
+int main(int argc, char **argv) {
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view arg = argv[i];
+        if (i + 1 >= argc) return usage(argv[0]);
+        if (arg == "--filter") options.filter = argv[++i];
+        else if (arg == "--min-time") options.min_time = std::strtod(argv[++i], nullptr);
+        else if (arg == "--json") options.json = argv[++i];
+        else return usage(argv[0]);
+    }
+
+    badge::warmup();
+    Suite suite{options};
+    benchBadges(suite);
+    benchBatch(suite);
+    benchXml(suite);
+    benchFont(suite);
+    benchNumber(suite);
+    benchColor(suite);
+    benchB64(suite);
+    benchIcons(suite);
+
+    if (options.json == "-") {
+        suite.writeJson(std::cout);
+    } else if (options.json) {
+        std::ofstream out{*options.json};
+        suite.writeJson(out);
+        if (!out) {
+            std::cerr << "failed to write " << *options.json << std::endl;
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,103 @@
+/// Copyright (c) 2024 MineYuanlu
+/// Author: MineYuanlu
+/// Github: https://github.com/MineYuanlu/badgecpp
+/// Licence: MIT
+#ifndef BADGECPP_ALLOC_STATS_HPP_GUARD
+#define BADGECPP_ALLOC_STATS_HPP_GUARD
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <ostream>
+/// @brief 堆分配统计, 用于测试与性能测试程序
+/// @details 库本身不替换全局 operator new; 需要统计的可执行文件在某一个源文件的全局作用域中展开一次
+///          BADGECPP_COUNTING_OPERATOR_NEW(), 之后在 Scope 的作用域内, 调用线程上的每次分配都会被计数.
+///          其他线程与作用域外的分配不计数.
+namespace badge::alloc_stats {
+
+    /// @brief 一段代码的分配统计
+    struct Report {
+        size_t allocations = 0;  ///< operator new 次数
+        size_t bytes = 0;        ///< operator new 请求的总字节数
+        size_t deallocations = 0;///< operator delete 次数 (不含空指针)
+
+        Report &operator+=(const Report &other) {
+            allocations += other.allocations;
+            bytes += other.bytes;
+            deallocations += other.deallocations;
+            return *this;
+        }
+        friend std::ostream &operator<<(std::ostream &os, const Report &r) {
+            return os << r.allocations << " allocs, " << r.bytes << " bytes, " << r.deallocations << " frees";
+        }
+    };
+
+    namespace detail {
+        struct State {
+            Report report;     ///< 当前最内层 Scope 的统计
+            unsigned depth = 0;///< 嵌套的 Scope 层数, 为0时不计数
+        };
+        /// @brief 常量初始化且可平凡析构, 在 operator new 中访问不会触发初始化或分配
+        inline thread_local State state;
+    }// namespace detail
+
+    /// @brief 由计数用的 operator new 调用
+    inline void onAllocate(size_t size) noexcept {
+        auto &s = detail::state;
+        if (s.depth) {
+            ++s.report.allocations;
+            s.report.bytes += size;
+        }
+    }
+    /// @brief 由计数用的 operator delete 调用
+    inline void onDeallocate(const void *p) noexcept {
+        auto &s = detail::state;
+        if (s.depth && p) ++s.report.deallocations;
+    }
+
+    /// @brief 统计作用域内调用线程的分配, 可以嵌套, 内层的计数同时计入外层
+    class Scope final {
+        Report outer_;
+
+    public:
+        Scope() noexcept : outer_(detail::state.report) {
+            detail::state.report = {};
+            ++detail::state.depth;
+        }
+        ~Scope() {
+            --detail::state.depth;
+            outer_ += detail::state.report;
+            detail::state.report = outer_;
+        }
+        Scope(const Scope &) = delete;
+        Scope &operator=(const Scope &) = delete;
+
+        /// @brief 进入作用域以来的统计
+        [[nodiscard]] Report report() const noexcept { return detail::state.report; }
+    };
+
+    /// @brief 统计一次调用的分配
+    template<typename F>
+    Report measure(F &&f) {
+        Scope scope;
+        f();
+        return scope.report();
+    }
+}// namespace badge::alloc_stats
+
+/// @brief 定义计数用的全局 operator new / delete, 在可执行文件中展开一次
+#define BADGECPP_COUNTING_OPERATOR_NEW()                                              \
+    void *operator new(std::size_t size) {                                            \
+        ::badge::alloc_stats::onAllocate(size);                                       \
+        if (void *p = std::malloc(size ? size : 1)) return p;                         \
+        throw std::bad_alloc{};                                                       \
+    }                                                                                 \
+    void *operator new[](std::size_t size) { return ::operator new(size); }           \
+    void operator delete(void *p) noexcept {                                          \
+        ::badge::alloc_stats::onDeallocate(p);                                        \
+        std::free(p);                                                                 \
+    }                                                                                 \
+    void operator delete[](void *p) noexcept { ::operator delete(p); }                \
+    void operator delete(void *p, std::size_t) noexcept { ::operator delete(p); }     \
+    void operator delete[](void *p, std::size_t) noexcept { ::operator delete(p); }   \
+    static_assert(true, "")
+#endif// BADGECPP_ALLOC_STATS_HPP_GUARD
@@ -1,13 +1,19 @@
 #ifndef BADGECPP_B64_H
 #define BADGECPP_B64_H
 
+#include <cstddef>
 #include <cstdint>
+#include <iosfwd>
 #include <string>
 #include <vector>
 
 namespace badge::b64 {
 
+    /// @brief 编码后的长度 (含填充)
+    constexpr size_t encoded_size(size_t dlen) { return (dlen + 2) / 3 * 4; }
+
     /// @brief 将数据编码为b64
+    /// @details 按块读取并编码, 适用于大数据
     /// @param in 数据输入流
     /// @param out b64输出流
     void b64encode(std::istream &in, std::ostream &out);
@@ -18,6 +24,13 @@ namespace badge::b64 {
     /// @return b64字符串
     std::string b64encode(const uint8_t *data, uint32_t dlen);
 
+    /// @brief 将数据编码为b64, 写入调用方提供的缓冲区
+    /// @param data 数据头指针
+    /// @param dlen 数据长度
+    /// @param out 输出缓冲区, 至少 encoded_size(dlen) 字节, 不会写入结尾的 '\0'
+    /// @return 写入的字节数, 即 encoded_size(dlen)
+    size_t b64encode(const uint8_t *data, size_t dlen, char *out);
+
     /// @brief 将b64解码为数据
     /// @param data b64字符串
     /// @return 数据
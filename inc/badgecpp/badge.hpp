@@ -10,6 +10,7 @@
 #include <memory>
 #include <optional>
 #include <string>
+#include <string_view>
 namespace badge {
 
 
@@ -33,6 +34,31 @@ namespace badge {
         return "UNKNOWN";
     }
 
+    /// @brief 不拥有文字的徽章参数
+    /// @details 文字字段直接引用调用者的缓冲区 (例如请求缓冲区), 渲染时只在最终转义写出时复制一次.
+    ///          所引用的文字与 logo 在渲染期间必须有效.
+    struct BadgeView final {
+        std::optional<std::string_view> label_{};    ///< 标签文字
+        std::optional<Color> label_color_{};         ///< 标签背景颜色
+        std::optional<std::string_view> message_{};  ///< 信息文字
+        std::optional<Color> message_color_{};       ///< 信息背景颜色
+        Style style_ = FLAT;                         ///< 徽章样式
+        const Icon *logo_ = nullptr;                 ///< 徽章logo, 不拥有
+        std::optional<Color> logo_color_{};          ///< 徽章logo颜色, 默认为logo自带的颜色
+        std::optional<unsigned int> logo_width_{};   ///< 徽章logo宽度, 默认为14
+        std::optional<std::string_view> id_suffix_{};///< 徽章id后缀, 用于区分不同badge
+
+
+        [[nodiscard]] std::string makeBadge() const;
+        /// @brief 生成徽章, 直接写入缓冲区而不构建Xml节点树
+        /// @param out 输出缓冲区, 结果追加到末尾
+        void makeBadge(std::string &out) const;
+        [[nodiscard]] Xml makeBadgeXml() const;
+        /// @brief 生成徽章节点树, 所有节点都从 resource 中分配
+        /// @param resource 内存资源, 例如 std::pmr::monotonic_buffer_resource, 其生命周期必须长于返回的节点树
+        [[nodiscard]] pmr::Xml makeBadgeXml(std::pmr::memory_resource *resource) const;
+    };
+
     struct Badge final {
         std::optional<std::string> label_{};      ///< 标签文字
         std::optional<Color> label_color_{};      ///< 标签背景颜色
@@ -46,7 +72,25 @@ namespace badge {
 
 
         [[nodiscard]] std::string makeBadge() const;
+        /// @brief 生成徽章, 直接写入缓冲区而不构建Xml节点树
+        /// @param out 输出缓冲区, 结果追加到末尾
+        void makeBadge(std::string &out) const;
         [[nodiscard]] Xml makeBadgeXml() const;
+        /// @brief 生成徽章节点树, 所有节点都从 resource 中分配
+        /// @param resource 内存资源, 例如 std::pmr::monotonic_buffer_resource, 其生命周期必须长于返回的节点树
+        [[nodiscard]] pmr::Xml makeBadgeXml(std::pmr::memory_resource *resource) const;
+
+        /// @brief 引用本徽章字段的视图, 在本徽章被修改或析构前有效
+        [[nodiscard]] BadgeView view() const;
+
+        /// @brief 逐字段比较, logo 按实例(指针)比较
+        bool operator==(const Badge &other) const;
+        bool operator!=(const Badge &other) const { return !(*this == other); }
     };
+
+    /// @brief 预先完成所有延迟初始化: 字体注册表, 全部内置图标, 各样式的渲染器
+    /// @details 库本身按需初始化, 长期运行的服务可以在启动时调用此函数, 避免首个请求承担这部分开销.
+    ///          线程安全, 可重复调用.
+    void warmup();
 }// namespace badge
 #endif// BADGECPP_BADGE_HPP_GUARD
@@ -0,0 +1,61 @@
+/// Copyright (c) 2024 MineYuanlu
+/// Author: MineYuanlu
+/// Github: https://github.com/MineYuanlu/badgecpp
+/// Licence: MIT
+#ifndef BADGECPP_BATCH_HPP_GUARD
+#define BADGECPP_BATCH_HPP_GUARD
+#include "badgecpp/badge.hpp"
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+namespace badge {
+
+    /// @brief 批量渲染的结果: 所有svg首尾相接存放在一块连续缓冲区中
+    class BatchOutput final {
+    public:
+        /// @brief 徽章个数
+        [[nodiscard]] std::size_t size() const noexcept { return offsets_.size() - 1; }
+        /// @brief 第 i 个徽章的svg, 在 BatchOutput 析构前有效
+        [[nodiscard]] std::string_view operator[](std::size_t i) const noexcept {
+            return {data_.data() + offsets_[i], offsets_[i + 1] - offsets_[i]};
+        }
+        /// @brief 连续缓冲区
+        [[nodiscard]] const std::string &data() const noexcept { return data_; }
+        /// @brief 偏移表, 共 size()+1 项, 第 i 个徽章为 [offsets[i], offsets[i+1])
+        [[nodiscard]] const std::vector<std::size_t> &offsets() const noexcept { return offsets_; }
+
+    private:
+        friend struct BatchRenderer;
+        std::string data_;
+        std::vector<std::size_t> offsets_{0};
+    };
+
+    /// @brief 批量渲染选项
+    struct BatchOptions {
+        unsigned int threads = 1;    ///< 工作线程数, 0 表示 std::thread::hardware_concurrency()
+        std::size_t chunk_size = 64; ///< 每次领取的徽章个数, 越小负载越均衡, 越大调度开销越小
+    };
+
+    /// @brief 批量渲染徽章
+    /// @details 多线程时各线程从共享计数器领取分块, 渲染到各自的缓冲区, 最后按原顺序拼接;
+    ///          结果与逐个调用 Badge::makeBadge 逐字节一致, 与线程数无关.
+    /// @param badges 徽章数组
+    /// @param count 徽章个数
+    /// @throws 任一徽章渲染失败时, 等待所有线程结束后重新抛出第一个异常
+    [[nodiscard]] BatchOutput renderBatch(const Badge *badges, std::size_t count, const BatchOptions &options = {});
+    /// @brief 批量渲染徽章
+    /// @see renderBatch(const Badge *, std::size_t, const BatchOptions &)
+    [[nodiscard]] inline BatchOutput renderBatch(const std::vector<Badge> &badges, const BatchOptions &options = {}) {
+        return renderBatch(badges.data(), badges.size(), options);
+    }
+    /// @brief 批量渲染徽章视图, 文字直接从视图引用的缓冲区写出
+    /// @see renderBatch(const Badge *, std::size_t, const BatchOptions &)
+    [[nodiscard]] BatchOutput renderBatch(const BadgeView *badges, std::size_t count, const BatchOptions &options = {});
+    /// @brief 批量渲染徽章视图
+    /// @see renderBatch(const BadgeView *, std::size_t, const BatchOptions &)
+    [[nodiscard]] inline BatchOutput renderBatch(const std::vector<BadgeView> &badges, const BatchOptions &options = {}) {
+        return renderBatch(badges.data(), badges.size(), options);
+    }
+}// namespace badge
+#endif// BADGECPP_BATCH_HPP_GUARD
\ No newline at end of file
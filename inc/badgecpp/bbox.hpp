@@ -11,6 +11,10 @@ namespace badge {
         [[nodiscard]] constexpr int area() const {
             return w * h;
         }
+        [[nodiscard]] constexpr bool operator==(const BBox &o) const {
+            return x == o.x && y == o.y && w == o.w && h == o.h;
+        }
+        [[nodiscard]] constexpr bool operator!=(const BBox &o) const { return !(*this == o); }
     };
 }// namespace badge
 #endif
\ No newline at end of file
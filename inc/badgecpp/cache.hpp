@@ -0,0 +1,80 @@
+/// Copyright (c) 2024 MineYuanlu
+/// Author: MineYuanlu
+/// Github: https://github.com/MineYuanlu/badgecpp
+/// Licence: MIT
+#ifndef BADGECPP_CACHE_HPP_GUARD
+#define BADGECPP_CACHE_HPP_GUARD
+#include "badgecpp/badge.hpp"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+namespace badge {
+
+    /// @brief 徽章哈希, 覆盖 Badge 的全部字段, logo 按实例(指针)区分
+    struct BadgeHash {
+        std::size_t operator()(const Badge &b) const;
+    };
+
+    /// @brief 已渲染徽章的线程安全缓存
+    /// @details 按哈希分片, 每个分片一把读写锁: 命中只需共享锁, 不同分片之间互不影响.
+    ///          每个分片容量固定, 满后按 CLOCK 算法淘汰. 渲染在锁外进行.
+    class BadgeCache final {
+    public:
+        /// @brief 统计信息
+        struct Stats {
+            std::uint64_t hits;     ///< 命中次数
+            std::uint64_t misses;   ///< 未命中次数
+            std::uint64_t evictions;///< 淘汰次数
+            std::size_t size;       ///< 当前条目数
+        };
+
+        /// @param capacity 最大条目数, 平均分配到各分片 (至少每分片1条)
+        /// @param shards 分片数
+        explicit BadgeCache(std::size_t capacity = 4096, std::size_t shards = 16);
+        BadgeCache(const BadgeCache &) = delete;
+        BadgeCache &operator=(const BadgeCache &) = delete;
+
+        /// @brief 获取徽章svg, 未命中时渲染并放入缓存
+        /// @return 不可变的svg字符串, 被淘汰后仍然有效
+        [[nodiscard]] std::shared_ptr<const std::string> get(const Badge &badge);
+        /// @brief 仅查找, 不渲染 (同样计入命中/未命中次数)
+        /// @return 未命中时返回 nullptr
+        [[nodiscard]] std::shared_ptr<const std::string> find(const Badge &badge) const;
+        /// @brief 清空缓存 (统计信息保留)
+        void clear();
+
+        [[nodiscard]] Stats stats() const;
+        [[nodiscard]] std::size_t capacity() const { return shard_capacity_ * shards_.size(); }
+
+    private:
+        struct Node {
+            std::shared_ptr<const std::string> svg;
+            mutable std::atomic<bool> referenced{false};///< CLOCK 引用位, 命中时在共享锁下置位
+
+            explicit Node(std::shared_ptr<const std::string> svg) : svg(std::move(svg)) {}
+        };
+        struct Shard {
+            mutable std::shared_mutex mutex;
+            std::unordered_map<Badge, Node, BadgeHash> map;
+            std::vector<const Badge *> ring;///< CLOCK 环, 指向 map 中的键
+            std::size_t hand = 0;           ///< CLOCK 指针
+        };
+
+        [[nodiscard]] Shard &shard_of(std::size_t hash) const;
+        /// @brief 在持有独占锁时插入, 必要时淘汰
+        void insert(Shard &shard, const Badge &badge, std::shared_ptr<const std::string> svg);
+
+        std::size_t shard_capacity_;
+        std::vector<std::unique_ptr<Shard>> shards_;
+
+        mutable std::atomic<std::uint64_t> hits_{0};
+        mutable std::atomic<std::uint64_t> misses_{0};
+        std::atomic<std::uint64_t> evictions_{0};
+    };
+}// namespace badge
+#endif// BADGECPP_CACHE_HPP_GUARD
\ No newline at end of file
@@ -9,7 +9,6 @@
 #include <optional>
 #include <string>
 #include <string_view>
-#include <unordered_map>
 #include <utility>
 namespace badge {
     struct Color;
@@ -17,11 +16,10 @@ namespace badge {
         size_t operator()(const badge::Color &c) const;
     };
     struct Color final {
-        static const std::unordered_map<std::string_view, Color> named_colors;
-        static const std::unordered_map<Color, std::string, ColorHash> named_colors_reverse;
-
         std::array<uint8_t, 4> value{0, 0, 0, 255};
         static_assert(sizeof(value) == sizeof(uint32_t), "Color value must be 4 bytes");
+        /// @brief CSS currentColor 关键字: 使用上下文的颜色, 序列化为 "currentColor", 此时 value 无意义 (按黑色计算亮度)
+        bool current_color = false;
 
         Color() = default;
         Color(uint8_t r, uint8_t g, uint8_t b, uint8_t a = 255) : value{r, g, b, a} {}
@@ -30,9 +28,15 @@ namespace badge {
 
 
         /// @brief 转换为最短css颜色字符串
-        /// @return #RGB or #RRGGBB or rgba(R,G,B,A)
+        /// @return #RGB or #RRGGBB or rgba(R,G,B,A), 颜色名称更短时返回名称 (如 red, transparent), 或 currentColor
         [[nodiscard]] std::string to_str() const;
-        /// @brief 获取颜色的名字, 若无则返回nullopt
+        /// @brief to_str() 结果的最大字节数, 例如 "rgba(255,255,255,.9960)"
+        static constexpr size_t MAX_STR_LENGTH = 24;
+        /// @brief 同 to_str, 写入 out 而不分配内存
+        /// @param out 至少 MAX_STR_LENGTH 字节
+        /// @return 写入的字节数
+        size_t to_chars(char *out) const;
+        /// @brief 获取颜色的名字 (有多个时取最短的), 若无则返回nullopt
         [[nodiscard]] std::optional<std::string> name() const;
         /// @return 颜色的亮度值, [0, 1]
         /// @details Gray = (0.299 * R + 0.587 * G + 0.114 * B) / 255
@@ -40,6 +44,9 @@ namespace badge {
         /// @brief 将当前颜色当做背景颜色, 获取文字颜色的Hex字符串
         /// @return [文字颜色, 阴影颜色]
         [[nodiscard]] std::pair<std::string, std::string> getColorHexPairForBackground();
+        /// @brief 同 getColorHexPairForBackground, 返回静态字符串, 不分配内存
+        /// @return [文字颜色, 阴影颜色]
+        [[nodiscard]] std::pair<std::string_view, std::string_view> getTextColorsForBackground() const noexcept;
 
         [[nodiscard]] uint8_t &r() { return value[0]; }
         [[nodiscard]] uint8_t &g() { return value[1]; }
@@ -52,38 +59,39 @@ namespace badge {
         [[nodiscard]] uint8_t a() const { return value[3]; }
         [[nodiscard]] uint32_t rgba() const { return *reinterpret_cast<const uint32_t *>(value.data()); }
 
-        bool operator==(const Color &other) const { return value == other.value; }
-        bool operator!=(const Color &other) const { return value != other.value; }
+        bool operator==(const Color &other) const { return value == other.value && current_color == other.current_color; }
+        bool operator!=(const Color &other) const { return !(*this == other); }
 
         ///@brief 解析String
+        ///@note currentColor 无法用 RGBA 表示, 此处视为解析失败, 请使用 Color 的构造函数或返回 optional 的重载
         ///@param v 结果输出. 解析失败时也可能改变部分值
         ///@return 是否解析成功
-        static bool parseString(std::string_view str, std::array<uint8_t, 4> &v);
+        static bool parseString(std::string_view str, std::array<uint8_t, 4> &v) noexcept;
         ///@brief 解析Hex
         ///@param v 结果输出. 解析失败时也可能改变部分值
         ///@return 是否解析成功
-        static bool parseHex(std::string_view hex, std::array<uint8_t, 4> &v);
+        static bool parseHex(std::string_view hex, std::array<uint8_t, 4> &v) noexcept;
         ///@brief 解析RGB
         ///@param v 结果输出. 解析失败时也可能改变部分值
         ///@return 是否解析成功
-        static bool parseRGB(std::string_view rgb, std::array<uint8_t, 4> &v);
+        static bool parseRGB(std::string_view rgb, std::array<uint8_t, 4> &v) noexcept;
         ///@brief 解析RGBA
         ///@param v 结果输出. 解析失败时也可能改变部分值
         ///@return 是否解析成功
-        static bool parseRGBA(std::string_view rgba, std::array<uint8_t, 4> &v);
+        static bool parseRGBA(std::string_view rgba, std::array<uint8_t, 4> &v) noexcept;
         ///@brief 解析HSL
         ///@param v 结果输出. 解析失败时也可能改变部分值
         ///@return 是否解析成功
-        static bool parseHSL(std::string_view hsl, std::array<uint8_t, 4> &v);
+        static bool parseHSL(std::string_view hsl, std::array<uint8_t, 4> &v) noexcept;
         ///@brief 解析HSLA
         ///@param v 结果输出. 解析失败时也可能改变部分值
         ///@return 是否解析成功
-        static bool parseHSLA(std::string_view hsla, std::array<uint8_t, 4> &v);
-        ///@brief 解析Name
+        static bool parseHSLA(std::string_view hsla, std::array<uint8_t, 4> &v) noexcept;
+        ///@brief 解析Name (CSS 命名颜色及 transparent), 编译期完美哈希查找
         ///@param v 结果输出. 解析失败时也可能改变部分值
         ///@return 是否解析成功
-        static bool parseName(std::string_view name, std::array<uint8_t, 4> &v);
-        /// @brief 解析String, 解析失败返回nullopt
+        static bool parseName(std::string_view name, std::array<uint8_t, 4> &v) noexcept;
+        /// @brief 解析String (含 currentColor), 解析失败返回nullopt
         static std::optional<Color> parseString(std::string_view str);
         /// @brief 解析Hex, 解析失败返回nullopt
         static std::optional<Color> parseHex(std::string_view hex);
@@ -95,8 +103,31 @@ namespace badge {
         static std::optional<Color> parseHSL(std::string_view hsl);
         /// @brief 解析HSLA, 解析失败返回nullopt
         static std::optional<Color> parseHSLA(std::string_view hsla);
-        /// @brief 解析Name, 解析失败返回nullopt
+        /// @brief 解析Name (含 currentColor), 解析失败返回nullopt
         static std::optional<Color> parseName(std::string_view name);
     };
+
+    /// @brief 渲染时使用的已解析颜色
+    /// @details 序列化形式, 亮度和作为背景时的文字/阴影颜色只计算一次, 渲染中直接使用,
+    ///          不再反复调用 to_str() 再把结果解析回 Color.
+    ///          序列化形式保存在内联缓冲区中, 构造不分配内存.
+    struct ResolvedColor final {
+        double brightness = 0;  ///< 亮度, [0, 1]
+        std::string_view text;  ///< 作为背景时的文字颜色 (静态字符串)
+        std::string_view shadow;///< 作为背景时的文字阴影颜色 (静态字符串)
+
+        ResolvedColor() = default;
+        explicit ResolvedColor(const Color &color);
+        /// @brief 以 css 原文作为序列化形式 (例如默认颜色 "#4c1"), 超出内联缓冲区时使用 Color::to_str 的形式
+        /// @throws std::invalid_argument css 不是合法颜色
+        explicit ResolvedColor(std::string_view css);
+
+        /// @brief 序列化形式, 用于 fill 属性
+        [[nodiscard]] std::string_view str() const { return {str_, length_}; }
+
+    private:
+        char str_[Color::MAX_STR_LENGTH]{};
+        size_t length_ = 0;
+    };
 }// namespace badge
 #endif// BADGECPP_COLOR_HPP_GUARD
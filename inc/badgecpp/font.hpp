@@ -4,24 +4,64 @@
 /// Licence: MIT
 #ifndef BADGECPP_FONT_HPP_GUARD
 #define BADGECPP_FONT_HPP_GUARD
+#include <array>
+#include <cstddef>
+#include <cstdint>
 #include <functional>
 #include <iostream>
+#include <memory>
 #include <optional>
 #include <string>
+#include <string_view>
 #include <tuple>
 #include <unordered_map>
 #include <vector>
 namespace badge {
 
+    /// @brief 字体宽度查找表的只读视图
+    /// @details 内置字体指向 tools/font_maker.py 在编译期生成的 constexpr 数组;
+    ///          运行时加载的字体指向 Font 自己持有的存储.
+    struct FontTables {
+        const double *latin1;       ///< ASCII/Latin-1 直接索引表 (256项), 控制字符为0, 未知为 -1
+        const uint16_t *bmp_pages;  ///< BMP 两级页表: 高8位 -> 页号 (256项)
+        const uint16_t *bmp_cells;  ///< 每页256个 values 下标
+        const double *values;       ///< 去重后的宽度值
+        const char32_t *range_lower;///< 范围表 (SoA), 按 upper 升序
+        const char32_t *range_upper;
+        const double *range_width;
+        size_t range_count;
+    };
 
     class Font final {
         using Range = std::tuple<char32_t, char32_t, double>;
-        /// @brief [lower, upper, width]
-        /// @details 其中 lower 和 upper 表示字符编码的范围, width 表示该范围内字符的宽度
-        std::vector<Range> widths_{};
+        /// @brief 未知宽度
+        static constexpr double UNKNOWN = -1;
+        /// @brief 页表中表示未知宽度/无此页的下标
+        static constexpr uint16_t NO_INDEX = 0xFFFF;
+
+        /// @brief 查找表, 由 build() 构建或指向编译期生成的数组
+        FontTables tables_{};
+        /// @brief 运行时构建的查找表的存储, 内置字体为空; 不可变, 拷贝时共享
+        std::shared_ptr<const void> storage_{};
         unsigned int size_ = -1;
         double emWidth_ = -2;
 
+        /// @brief 由范围表构建所有查找结构
+        void build(std::vector<Range> widths);
+        /// @brief 在范围表中查找, 未知返回 UNKNOWN
+        [[nodiscard]] double lookupRange(char32_t charCode) const noexcept;
+        /// @brief 查找宽度 (非控制字符), 未知返回 UNKNOWN
+        [[nodiscard]] double lookup(char32_t charCode) const noexcept {
+            if (charCode < 0x100) return tables_.latin1[charCode];
+            if (charCode < 0x10000) {
+                const auto page = tables_.bmp_pages[charCode >> 8];
+                if (page == NO_INDEX) return UNKNOWN;
+                const auto index = tables_.bmp_cells[(size_t{page} << 8) | (charCode & 0xFF)];
+                return index == NO_INDEX ? UNKNOWN : tables_.values[index];
+            }
+            return lookupRange(charCode);
+        }
+
     public:
         static constexpr char GUESS_CHAR = 'm';
 
@@ -35,6 +75,11 @@ namespace badge {
         /// @brief 构造函数
         Font(std::vector<std::tuple<char32_t, char32_t, double>> widths, unsigned int size);
 
+        /// @brief 由已构建好的查找表构造, 不复制也不分配内存
+        /// @details 用于编译期生成的内置字体, tables 必须在 Font 的整个生命周期内有效
+        constexpr Font(const FontTables &tables, unsigned int size, double emWidth) noexcept
+            : tables_(tables), size_(size), emWidth_(emWidth) {}
+
         /// @brief 获取char宽度
         /// @param c 字符编码
         /// @param guess 如果宽度未知, 是否猜测为 emWidth_
@@ -53,6 +98,20 @@ namespace badge {
         /// @return 字符串宽度, -1代表有任一未知且不猜测
         [[nodiscard]] double widthOfString(const std::string &s, bool guess = true) const noexcept;
 
+        /// @brief 获取UTF-8字符串宽度
+        /// @details 边解码边累加, 不分配内存; 非法的UTF-8字节按 U+FFFD 计算
+        /// @param s UTF-8字符串
+        /// @param guess 如果宽度未知, 是否猜测为 emWidth_
+        /// @return 字符串宽度, -1代表有任一未知且不猜测
+        [[nodiscard]] double widthOfString(std::string_view s, bool guess = true) const noexcept;
+
+        /// @brief 获取UTF-8字符串宽度, 同时统计码点个数
+        /// @param s UTF-8字符串
+        /// @param guess 如果宽度未知, 是否猜测为 emWidth_
+        /// @param codepoints 输出码点个数 (非法字节各计为一个)
+        /// @return 字符串宽度, -1代表有任一未知且不猜测
+        [[nodiscard]] double widthOfString(std::string_view s, bool guess, size_t &codepoints) const noexcept;
+
 
         /// @brief 获取字符串宽度
         /// @param s 字符串, 如果为nullopt则返回0
@@ -98,7 +157,8 @@ namespace badge {
         /// @throws std::runtime_error 无法解析json reader
         static Font createByJsonReader(std::function<char()> reader, unsigned int size, unsigned int prepareElementsSize = 0);
 
-        static std::u32string toU32String(const std::string &str);
+        /// @brief UTF-8 转 UTF-32, 非法的UTF-8字节转为 U+FFFD, 不抛出异常
+        static std::u32string toU32String(std::string_view str);
 
     private:
         Font() = default;
@@ -127,20 +187,25 @@ namespace badge {
 
 
         /// @brief 获取字体
-        /// @param fontName 字体枚举值
+        /// @param fontName 字体名
         /// @throw std::runtime_error 字体不存在
         /// @return 字体
-        static const Font *get(const std::string &fontName);
+        static const Font *get(std::string_view fontName);
+
+        /// @brief 获取内置字体, 不存在时返回 nullptr
+        /// @details 内置字体是编译期生成的查找表视图, 查询不会触发任何初始化或内存分配
+        static const Font *getBuiltin(std::string_view fontName) noexcept;
 
-        /// @brief 获取所有字体
-        static const std::unordered_map<std::string, Font> &getFonts() noexcept;
+        /// @brief 获取所有字体 (含内置字体)
+        /// @details 首次调用时构建映射表 (内置字体被复制进来), 因此可能抛出 std::bad_alloc
+        static const std::unordered_map<std::string, Font> &getFonts();
 
         /// @brief 创建字体
         static void createFont(std::string fontName, Font font);
 
     private:
         std::unordered_map<std::string, Font> fontMap;
-        Fonts() = default;
+        Fonts();
         static Fonts &instance();
     };
 
@@ -4,6 +4,7 @@
 #include "color.hpp"
 #include <cstddef>
 #include <memory>
+#include <mutex>
 #include <optional>
 #include <string>
 #include <string_view>
@@ -13,6 +14,8 @@ namespace badge {
         virtual ~Icon() = default;
         /// @brief 获取图标uri格式的数据
         [[nodiscard]] virtual std::string get_uri(const std::optional<Color> &color = std::nullopt, std::optional<BBox> pos = std::nullopt) const = 0;
+        /// @brief 获取图标uri格式的数据, 返回共享的不可变字符串, 实现可以缓存结果
+        [[nodiscard]] virtual std::shared_ptr<const std::string> get_uri_shared(const std::optional<Color> &color = std::nullopt, std::optional<BBox> pos = std::nullopt) const;
         /// @brief 获取图标uri格式的数据
         [[nodiscard]] virtual std::string get_svg(const std::optional<Color> &color = std::nullopt, std::optional<BBox> pos = std::nullopt) const = 0;
         /// @brief 获取图标基准颜色
@@ -27,33 +30,121 @@ namespace badge {
 
         BuiltinIcon(std::string_view title, Color color, std::string_view icon);
         BuiltinIcon(std::string_view title, std::string color, const void *data, size_t size);
+        /// @brief 复制图标数据与缓存容量, 副本的uri缓存为空
+        BuiltinIcon(const BuiltinIcon &other);
+        /// @brief 被移动的图标不再缓存uri
+        BuiltinIcon(BuiltinIcon &&other) noexcept;
+        ~BuiltinIcon() override;
 
         [[nodiscard]] std::string get_uri(const std::optional<Color> &color = std::nullopt, std::optional<BBox> pos = std::nullopt) const override;
+        /// @brief 同 get_uri, 但结果按 (color, pos) 缓存在图标内, 线程安全
+        [[nodiscard]] std::shared_ptr<const std::string> get_uri_shared(const std::optional<Color> &color = std::nullopt, std::optional<BBox> pos = std::nullopt) const override;
         [[nodiscard]] std::string get_svg(const std::optional<Color> &color = std::nullopt, std::optional<BBox> pos = std::nullopt) const override;
         [[nodiscard]] Color get_color() const override;
+
+        /// @brief 设置本图标最多缓存的uri个数, 0 表示不缓存, 默认为 8
+        void set_uri_cache_capacity(size_t capacity);
+        [[nodiscard]] size_t uri_cache_capacity() const;
+
+    private:
+        struct UriCache;
+        std::unique_ptr<UriCache> uri_cache_;///< 放在堆上, 使图标可以复制与移动
     };
 
     /// @brief From Simple Icons
     /// https://github.com/simple-icons
+    /// @details 直接使用嵌入的二进制索引 (由 tools/icons_tar.py 生成, 含标题与 slug 的最小完美哈希表),
+    ///          启动时不解析; 图标实例在首次被查找时才创建, 均为线程安全
     struct BuiltinIcons final {
-
-        /// @brief 获取所有的内置图标
+        /// @brief 获取所有的内置图标 (按标题排序)
+        /// @note 会创建全部图标实例, 仅需单个图标时请使用 by_title
         static const std::vector<std::shared_ptr<BuiltinIcon>> &icons();
 
         /// @brief 获取内置图标管理器实例
         static BuiltinIcons &instance();
 
-        /// @brief 根据标题查找内置图标
+        /// @brief 内置图标个数, 不创建图标实例
+        static size_t size();
+
+        /// @brief 根据标题查找内置图标, O(1)
         /// @param title 图标标题
         /// @return 内置图标实例，如果没有找到则返回 nullptr
         static std::shared_ptr<BuiltinIcon> by_title(std::string_view title);
 
+        /// @brief 根据 slug 查找内置图标, O(1)
+        /// @param slug simple-icons 的 slug, 例如 "cplusplus"
+        /// @return 内置图标实例，如果没有找到则返回 nullptr
+        static std::shared_ptr<BuiltinIcon> by_slug(std::string_view slug);
+
+        /// @brief 大小写不敏感地根据标题查找内置图标 (只折叠 ASCII 字母), O(1)
+        /// @return 内置图标实例，如果没有找到则返回 nullptr
+        static std::shared_ptr<BuiltinIcon> by_title_nocase(std::string_view title);
+
+        /// @brief 依次按 标题, slug, 大小写不敏感的标题 查找, 适合处理用户传入的 logo 参数
+        /// @return 内置图标实例，如果没有找到则返回 nullptr
+        static std::shared_ptr<BuiltinIcon> lookup(std::string_view name);
+
+        /// @brief 前缀补全: 小写标题或 slug 以 prefix 开头的图标 (大小写不敏感), 按字典序
+        /// @param limit 最多返回的个数
+        static std::vector<std::shared_ptr<BuiltinIcon>> complete(std::string_view prefix, size_t limit = 10);
+
+        /// @brief 模糊查找 ("did you mean"): 小写标题或 slug 与 name 的编辑距离不超过 max_distance 的图标
+        /// @details 在前缀树上逐字节计算 Levenshtein 距离, 超出距离的分支被剪枝;
+        ///          只计算对角线两侧 max_distance 宽的带, 比最长名称还长 max_distance 以上的 name 直接返回空
+        /// @param limit 最多返回的个数
+        /// @return 按 (编辑距离, 标题) 排序
+        static std::vector<std::shared_ptr<BuiltinIcon>> suggest(std::string_view name, size_t max_distance = 2, size_t limit = 5);
+
     private:
+        /// @brief 二进制索引中的一张最小完美哈希表
+        struct HashTable {
+            const char *disp = nullptr; ///< uint32_t[buckets], 每个桶的位移种子
+            const char *slots = nullptr;///< uint32_t[keys], 槽位 -> 图标下标
+            uint32_t keys = 0;
+            uint32_t buckets = 0;
+        };
+        /// @brief 前缀树节点
+        struct TrieNode {
+            std::string_view label;///< 从父节点到此节点的边标签
+            uint32_t first_child;
+            uint32_t child_count;
+            uint32_t icons_begin;///< node_icons 中的起始下标
+            uint32_t icons_count;
+        };
+        /// @brief 延迟创建的图标实例
+        struct Entry {
+            std::once_flag once;
+            std::shared_ptr<BuiltinIcon> icon;
+        };
+
         BuiltinIcons();
         BuiltinIcons(const BuiltinIcons &) = delete;
         BuiltinIcons &operator=(const BuiltinIcons &) = delete;
         BuiltinIcons(BuiltinIcons &&) = delete;
         BuiltinIcons &operator=(BuiltinIcons &&) = delete;
+
+        /// @brief 读取第 index 个记录的第 field 个字符串字段
+        [[nodiscard]] std::string_view record_str(size_t index, size_t field) const;
+        /// @brief 在哈希表中查找, field 为用于校验的字符串字段
+        /// @param ignore_case 校验时是否忽略 ASCII 大小写 (key 须已转为小写)
+        /// @return 图标下标, 未找到返回 size_
+        [[nodiscard]] size_t find(const HashTable &table, size_t field, std::string_view key, bool ignore_case = false) const;
+        [[nodiscard]] TrieNode node(size_t index) const;
+        [[nodiscard]] uint32_t node_icon(size_t index) const;
+        /// @brief 获取第 index 个图标, 必要时创建
+        const std::shared_ptr<BuiltinIcon> &get(size_t index);
+
+        const char *records_ = nullptr;///< 固定宽度的记录, 按标题排序
+        std::string_view strings_;
+        std::string_view data_;
+        HashTable titles_, slugs_, lower_titles_;
+        const char *nodes_ = nullptr;///< 前缀树节点, nodes_[0] 为根
+        const char *node_icons_ = nullptr;
+        size_t node_count_ = 0;
+        size_t max_name_length_ = 0;///< 最长的标题或 slug 的字节数, 即前缀树的最大深度
+        size_t size_ = 0;
+        std::unique_ptr<Entry[]> entries_;
+        std::once_flag icons_once_;
         std::vector<std::shared_ptr<BuiltinIcon>> icons_;
     };
 }// namespace badge
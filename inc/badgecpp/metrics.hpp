@@ -0,0 +1,156 @@
+/// Copyright (c) 2024 MineYuanlu
+/// Author: MineYuanlu
+/// Github: https://github.com/MineYuanlu/badgecpp
+/// Licence: MIT
+#ifndef BADGECPP_METRICS_HPP_GUARD
+#define BADGECPP_METRICS_HPP_GUARD
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+/// @brief 渲染热路径的分阶段统计
+/// @details 仅在定义 BADGECPP_METRICS 时 (CMake 选项 BADGECPP_METRICS) 记录, 否则埋点宏展开为空, 没有任何开销;
+///          查询接口始终可用, 关闭时返回全零的快照.
+///          每个线程写入自己的计数器 (只有一个写者, relaxed 原子读写, 无锁), 快照时合并所有线程.
+namespace badge::metrics {
+
+    /// @brief 是否编译了统计
+#ifdef BADGECPP_METRICS
+    constexpr bool enabled = true;
+#else
+    constexpr bool enabled = false;
+#endif
+
+    /// @brief 渲染阶段
+    /// @note 阶段可以嵌套, 例如 ICON_URI 发生在 CALC_VALUES / BUILD_TREE / WRITE_STREAM 之内, 其耗时同时计入两者
+    enum class Phase : unsigned int {
+        CALC_VALUES, ///< Render::layout, 计算尺寸与颜色
+        BUILD_TREE,  ///< 构建 Xml / pmr::Xml 节点树
+        WRITE_STREAM,///< 流式写出svg
+        ICON_URI,    ///< BuiltinIcon::get_uri_shared, 含缓存查找与未命中时的编码
+        XML_RENDER,  ///< Xml::render / pmr::Xml::render 序列化节点树
+    };
+    constexpr size_t PHASE_COUNT = 5;
+    constexpr const char *phase_str(Phase phase) {
+        switch (phase) {
+                // clang-format off
+            case Phase::CALC_VALUES: return "calc_values";
+            case Phase::BUILD_TREE: return "build_tree";
+            case Phase::WRITE_STREAM: return "write_stream";
+            case Phase::ICON_URI: return "icon_uri";
+            case Phase::XML_RENDER: return "xml_render";
+                // clang-format on
+        }
+        return "unknown";
+    }
+
+    /// @brief 以2的幂为上界的直方图
+    struct Histogram {
+        /// @brief 桶个数, 第 i 个桶的上界 (含) 为 2^i, 最后一个桶为 +Inf
+        static constexpr size_t BUCKETS = 32;
+
+        uint64_t count = 0;                  ///< 样本个数
+        uint64_t sum = 0;                    ///< 样本总和
+        std::array<uint64_t, BUCKETS> buckets{};///< 各桶的样本个数 (非累积)
+
+        /// @brief 样本所属的桶
+        static constexpr size_t bucketOf(uint64_t value) {
+            size_t i = 0;
+            for (uint64_t bound = 1; bound < value && i + 1 < BUCKETS; bound <<= 1) ++i;
+            return i;
+        }
+        /// @brief 第 i 个桶的上界, 最后一个桶返回 UINT64_MAX
+        static constexpr uint64_t upperBound(size_t i) { return i + 1 < BUCKETS ? uint64_t{1} << i : UINT64_MAX; }
+    };
+
+    /// @brief 所有线程合并后的统计快照
+    struct Snapshot {
+        std::array<Histogram, PHASE_COUNT> phase_ns{};///< 各阶段耗时 (纳秒)
+        Histogram render_ns;                          ///< 一次完整渲染 (Render::render) 的耗时 (纳秒)
+        Histogram output_bytes;                       ///< 每个输出文档的字节数
+        Histogram output_nodes;                       ///< 每个输出文档的节点 (元素) 个数
+
+        [[nodiscard]] const Histogram &phase(Phase p) const { return phase_ns[static_cast<size_t>(p)]; }
+    };
+
+    /// @brief 一次渲染的样本, 交给 Sink
+    /// @details 流式渲染时包含输出的字节数与节点数; 返回节点树的渲染在之后调用 Xml::render 时才统计输出, 此处为0
+    struct RenderSample {
+        std::array<uint64_t, PHASE_COUNT> phase_ns{};///< 本次渲染中各阶段的累计耗时 (纳秒)
+        uint64_t total_ns = 0;                       ///< 总耗时 (纳秒)
+        uint64_t bytes = 0;                          ///< 输出字节数
+        uint64_t nodes = 0;                          ///< 输出节点数
+    };
+
+    /// @brief 可插拔的样本接收器, 在每次渲染结束时于渲染线程上调用
+    struct Sink {
+        virtual ~Sink() = default;
+        virtual void onRender(const RenderSample &sample) noexcept = 0;
+    };
+
+    /// @brief 设置样本接收器, nullptr 表示不接收
+    /// @note sink 的生命周期由调用者保证, 替换后仍可能有正在进行的渲染调用旧的 sink
+    void setSink(Sink *sink) noexcept;
+
+    /// @brief 合并所有线程 (含已退出的线程) 的统计
+    [[nodiscard]] Snapshot snapshot();
+
+    /// @brief 清零统计: 之后的快照只包含此后的样本
+    void reset();
+
+    /// @brief Prometheus 文本格式 (text/plain; version=0.0.4)
+    [[nodiscard]] std::string exposition(const Snapshot &snapshot);
+    /// @see exposition(const Snapshot &)
+    [[nodiscard]] inline std::string exposition() { return exposition(snapshot()); }
+
+    namespace detail {
+        [[nodiscard]] uint64_t now() noexcept;
+        void recordPhase(Phase phase, uint64_t ns) noexcept;
+        /// @brief 记录一个输出文档的字节数与节点数
+        void recordOutput(std::string_view out) noexcept;
+
+        /// @brief 作用域内计时一个阶段
+        class PhaseTimer final {
+            Phase phase_;
+            uint64_t start_;
+
+        public:
+            explicit PhaseTimer(Phase phase) noexcept : phase_(phase), start_(now()) {}
+            ~PhaseTimer() { recordPhase(phase_, now() - start_); }
+            PhaseTimer(const PhaseTimer &) = delete;
+            PhaseTimer &operator=(const PhaseTimer &) = delete;
+        };
+
+        /// @brief 作用域内为一次完整渲染, 收集其中各阶段的样本, 结束时记录总耗时并交给 Sink
+        class RenderScope final {
+            RenderSample sample_;
+            RenderSample *outer_;
+            uint64_t start_;
+
+        public:
+            RenderScope() noexcept;
+            ~RenderScope();
+            RenderScope(const RenderScope &) = delete;
+            RenderScope &operator=(const RenderScope &) = delete;
+        };
+    }// namespace detail
+}// namespace badge::metrics
+
+#define BADGECPP_METRICS_CONCAT_(a, b) a##b
+#define BADGECPP_METRICS_CONCAT(a, b) BADGECPP_METRICS_CONCAT_(a, b)
+#ifdef BADGECPP_METRICS
+/// @brief 计时当前作用域, phase 为 badge::metrics::Phase 的枚举名
+#define BADGECPP_METRICS_PHASE(phase) \
+    const ::badge::metrics::detail::PhaseTimer BADGECPP_METRICS_CONCAT(badgecpp_metrics_phase_, __LINE__) { ::badge::metrics::Phase::phase }
+/// @brief 当前作用域为一次完整渲染
+#define BADGECPP_METRICS_RENDER() \
+    const ::badge::metrics::detail::RenderScope BADGECPP_METRICS_CONCAT(badgecpp_metrics_render_, __LINE__) {}
+/// @brief 记录一个输出文档
+#define BADGECPP_METRICS_OUTPUT(out) ::badge::metrics::detail::recordOutput(out)
+#else
+#define BADGECPP_METRICS_PHASE(phase) static_cast<void>(0)
+#define BADGECPP_METRICS_RENDER() static_cast<void>(0)
+#define BADGECPP_METRICS_OUTPUT(out) static_cast<void>(0)
+#endif
+#endif// BADGECPP_METRICS_HPP_GUARD
@@ -9,7 +9,46 @@
 #include <memory>
 #include <optional>
 #include <string>
+#include <string_view>
 namespace badge {
+    /// @brief 一个徽章的布局, 由 Render::layout 计算, 渲染时只读
+    /// @details 一次渲染的全部中间结果都在这里, 渲染器本身不保存状态
+    struct Layout {
+        BadgeView badge;///< 徽章参数, 其引用的文字在布局使用期间必须有效
+        bool hasLogo = false;
+        bool hasLabel = false;
+        bool hasMessage = false;
+        unsigned int logo_width = 0;
+        unsigned int label_margin = 0;
+        unsigned int label_width = 0;
+        unsigned int message_width = 0;
+        unsigned int message_margin = 0;
+        unsigned int left_width = 0;
+        unsigned int right_width = 0;
+        unsigned int height = 0;
+        unsigned int width = 0;
+        ResolvedColor label_color;  ///< 标签背景颜色, 未指定时为默认颜色
+        ResolvedColor message_color;///< 信息背景颜色, 未指定时为默认颜色
+        std::optional<std::string> body_link;
+        std::optional<std::string> left_link;
+        std::optional<std::string> right_link;
+        std::string_view idSuffix;///< 指向 badge.id_suffix_
+
+        // FOR_THE_BADGE 与 SOCIAL 样式的额外尺寸
+        unsigned int label_text_min_x = 0;  ///< 仅 FOR_THE_BADGE
+        unsigned int label_rect_width = 0;
+        unsigned int message_text_min_x = 0;///< 仅 FOR_THE_BADGE
+        unsigned int message_rect_width = 0;
+        std::string up_label;  ///< 仅 FOR_THE_BADGE, 大写的标签
+        std::string up_message;///< 仅 FOR_THE_BADGE, 大写的信息
+
+        explicit Layout(const BadgeView &badge) : badge(badge) {}
+    };
+
+    class BoundRender;
+
+    /// @brief 渲染器, 每种样式一个不可变的单例
+    /// @details 渲染器没有数据成员, 布局由 layout 计算为 Layout 值, 因此同一个渲染器可以被多个线程同时使用
     class Render {
     protected:
         enum class TextType {
@@ -18,54 +57,107 @@ namespace badge {
         };
 
     public:
-        explicit Render(const Badge &badge);
-        virtual ~Render() {}
-        virtual Xml render();
+        virtual ~Render() = default;
+        Render(const Render &) = delete;
+        Render &operator=(const Render &) = delete;
+
+        /// @brief 样式对应的渲染器单例
+        /// @throws std::runtime_error 不支持的样式
+        [[nodiscard]] static const Render &get(Style style);
+        /// @brief 绑定到 badge 的渲染器, 兼容旧的 create(badge)->render() 接口
+        /// @details 由 get(badge.style_) 与 badge.view() 的布局组成, badge 的生命周期必须长于返回值
+        /// @deprecated 使用 get(style).layout(badge.view()) 与 render(layout)
+        /// @throws std::runtime_error 不支持的样式
+        [[nodiscard]] static std::unique_ptr<BoundRender> create(const Badge &badge);
 
-        static std::unique_ptr<Render> create(const Badge &badge);
+        /// @brief 计算布局, 结果只依赖 badge 与样式
+        [[nodiscard]] virtual Layout layout(const BadgeView &badge) const = 0;
+        /// @brief 渲染为 Xml 节点树
+        /// @param l 由本渲染器的 layout 计算的布局
+        [[nodiscard]] Xml render(const Layout &l) const;
+        /// @brief 流式渲染, 不构建Xml节点树, 直接将svg写入缓冲区
+        /// @param out 输出缓冲区, 结果追加到末尾, 与 render(l).render() 的结果逐字节一致
+        void render(const Layout &l, std::string &out) const;
+        /// @brief 渲染为 pmr::Xml 节点树, 所有节点都从 resource 中分配
+        /// @param resource 内存资源, 其生命周期必须长于返回的节点树
+        [[nodiscard]] pmr::Xml render(const Layout &l, std::pmr::memory_resource *resource) const;
+
+        /// @brief 静态分派的流式渲染, 结果与 get(badge.style_) 的 layout 与 render 一致
+        /// @details 具体渲染器均为 final, 其中的布局查询不经过虚函数表, 可以被内联与常量折叠.
+        /// @throws std::runtime_error 不支持的样式
+        static void render(const BadgeView &badge, std::string &out);
+        /// @brief 静态分派的节点树渲染
+        /// @see render(const BadgeView &, std::string &)
+        [[nodiscard]] static Xml renderXml(const BadgeView &badge);
+        /// @brief 静态分派的 pmr 节点树渲染
+        /// @see render(const BadgeView &, std::string &)
+        [[nodiscard]] static pmr::Xml renderXml(const BadgeView &badge, std::pmr::memory_resource *resource);
 
     protected:
-        virtual void calcValues();
-        [[nodiscard]] virtual Xml renderSvg() const;
+        Render() = default;
+        /// @brief 计算布局的通用部分
+        /// @param self 具体渲染器; 为 final 类型时, 其中的查询都是静态调用
+        template<typename Self>
+        static void calcLayout(const Self &self, Layout &l);
+        template<typename Self>
+        static Layout timedLayout(const Self &self, const BadgeView &badge);
+        template<typename Self>
+        static Xml renderTree(const Self &self, const Layout &l);
+        template<typename Self>
+        static void renderStream(const Self &self, const Layout &l, std::string &out);
+        template<typename Self>
+        static pmr::Xml renderTree(const Self &self, const Layout &l, std::pmr::memory_resource *resource);
+        template<typename Self, typename Writer>
+        static void writeSvg(const Self &self, const Layout &l, Writer &w);
         [[nodiscard]] virtual unsigned int get_height() const = 0;
         [[nodiscard]] virtual unsigned int get_vertical_margin() const = 0;
         [[nodiscard]] virtual bool text_has_shadow() const = 0;
-        [[nodiscard]] virtual unsigned int get_str_width(const std::optional<std::string> &str, TextType tt) const;
-        [[nodiscard]] virtual Xml get_content() const = 0;
-        [[nodiscard]] virtual std::string get_accessible_text() const;
-        [[nodiscard]] virtual unsigned int get_logo_width() const;
+        /// @brief 是否使用 label_color / message_color, 为false时 calcLayout 不解析颜色
+        [[nodiscard]] virtual bool uses_colors() const { return true; }
+        [[nodiscard]] virtual unsigned int get_str_width(const Layout &l, const std::optional<std::string_view> &str, TextType tt) const;
+        virtual void write_content(const Layout &l, XmlWriter &w) const = 0;
+        virtual void write_content(const Layout &l, XmlBuilder &w) const = 0;
+        virtual void write_content(const Layout &l, pmr::XmlBuilder &w) const = 0;
+        [[nodiscard]] virtual unsigned int get_logo_width(const Layout &l) const;
 
 
     protected:// helpers functions
-        [[nodiscard]] Xml getClipPathElement(int rx) const;
-        [[nodiscard]] Xml getBackgroundGroupElement(bool withGradient, Xml::Attrs attrs) const;
-        [[nodiscard]] Xml getForegroundGroupElement() const;
-        [[nodiscard]] Xml getLogoElement(unsigned int horizPadding, unsigned int badgeHeight) const;
-        [[nodiscard]] Xml getTextElement(unsigned int left_margin, std::optional<std::string> content, const std::string &color, unsigned int width,
-                                         std::optional<std::string> link, unsigned int link_width) const;
-        [[nodiscard]] Xml getLabelElement() const;
-        [[nodiscard]] Xml getMessageElement() const;
+        template<typename Writer>
+        void writeClipPathElement(const Layout &l, Writer &w, int rx) const;
+        /// @param groupStart 未闭合的 g 开始标签模板, $0 为 idSuffix
+        template<typename Writer>
+        void writeBackgroundGroupElement(const Layout &l, Writer &w, bool withGradient, const XmlTemplate &groupStart) const;
+        template<typename Writer>
+        void writeForegroundGroupElement(const Layout &l, Writer &w) const;
+        template<typename Writer>
+        void writeLogoElement(const Layout &l, Writer &w, unsigned int horizPadding, unsigned int badgeHeight) const;
+        template<typename Writer>
+        void writeTextElement(const Layout &l, Writer &w, unsigned int left_margin, std::optional<std::string_view> content, const ResolvedColor &color, unsigned int width,
+                              const std::optional<std::string> &link, unsigned int link_width) const;
+        template<typename Writer>
+        void writeLabelElement(const Layout &l, Writer &w) const;
+        template<typename Writer>
+        void writeMessageElement(const Layout &l, Writer &w) const;
 
+    private:
+        /// @brief 以 style 对应的具体渲染器单例调用 f
+        template<typename F>
+        static decltype(auto) visit(Style style, F &&f);
+    };
 
-    protected:
-        const Badge &badge;
-        bool hasLogo;
-        bool hasLabel;
-        bool hasMessage;
-        unsigned int logo_width;
-        unsigned int label_margin;
-        unsigned int label_width;
-        unsigned int message_width;
-        unsigned int message_margin;
-        unsigned int left_width;
-        unsigned int right_width;
-        unsigned int height;
-        unsigned int width;
-        std::optional<std::string> body_link;
-        std::optional<std::string> left_link;
-        std::optional<std::string> right_link;
-        std::string accessible_test;
-        std::string idSuffix;
+    /// @brief 单例渲染器与一个徽章的布局, 由 Render::create 返回
+    class BoundRender final {
+    public:
+        BoundRender(const Render &render, const Badge &badge);
+        [[nodiscard]] Xml render() const;
+        /// @brief 流式渲染, 结果追加到 out 末尾, 与 render().render() 的结果逐字节一致
+        void render(std::string &out) const;
+        /// @brief 渲染为 pmr::Xml 节点树, 所有节点都从 resource 中分配
+        [[nodiscard]] pmr::Xml render(std::pmr::memory_resource *resource) const;
+
+    private:
+        const Render &render_;
+        Layout layout_;
     };
 }// namespace badge
 #endif// BADGECPP_RENDER_HPP_GUARD
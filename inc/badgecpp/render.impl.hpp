@@ -8,83 +8,112 @@
 #include "badgecpp/render.hpp"
 
 namespace badge {
-    class FlatRender final : public Render {
-    protected:
-        [[nodiscard]] unsigned int get_height() const override;
-        [[nodiscard]] Xml get_content() const override;
-        [[nodiscard]] unsigned int get_vertical_margin() const override;
-        [[nodiscard]] bool text_has_shadow() const override;
-
-    public:
-        using Render::Render;
+    /// @brief 样式常量
+    struct RenderTraits {
+        unsigned int height;         ///< 徽章高度
+        unsigned int vertical_margin;///< 文字的垂直偏移, 不使用通用文字元素的样式为0
+        bool text_has_shadow;        ///< 文字是否带阴影, 不使用通用文字元素的样式为false
+        bool uses_colors;            ///< 是否使用 label_color / message_color
     };
-    class FlatSquareRender final : public Render {
-    protected:
-        [[nodiscard]] unsigned int get_height() const override;
-        [[nodiscard]] Xml get_content() const override;
-        [[nodiscard]] unsigned int get_vertical_margin() const override;
-        [[nodiscard]] bool text_has_shadow() const override;
 
+    /// @brief 具体渲染器的CRTP基类
+    /// @details 样式常量查询由 Derived::TRAITS 实现, layout / write_content 静态转发到 Derived;
+    ///          Derived 需为 final, 提供 emit_content(const Layout &, Writer &) 模板, 并将 Render 与本类声明为友元.
+    ///          需要额外尺寸的样式在 Derived 中定义 calcValues(Layout &) 隐藏本类的版本.
+    template<typename Derived>
+    class StyledRender : public Render {
     public:
-        using Render::Render;
-    };
-    class PlasticRender final : public Render {
+        [[nodiscard]] Layout layout(const BadgeView &badge) const final {
+            Layout l{badge};
+            static_cast<const Derived &>(*this).calcValues(l);
+            return l;
+        }
+
     protected:
-        [[nodiscard]] unsigned int get_height() const override;
-        [[nodiscard]] Xml get_content() const override;
-        [[nodiscard]] unsigned int get_vertical_margin() const override;
-        [[nodiscard]] bool text_has_shadow() const override;
+        [[nodiscard]] unsigned int get_height() const final { return Derived::TRAITS.height; }
+        [[nodiscard]] unsigned int get_vertical_margin() const final { return Derived::TRAITS.vertical_margin; }
+        [[nodiscard]] bool text_has_shadow() const final { return Derived::TRAITS.text_has_shadow; }
+        [[nodiscard]] bool uses_colors() const final { return Derived::TRAITS.uses_colors; }
+        void calcValues(Layout &l) const { calcLayout(static_cast<const Derived &>(*this), l); }
+        void write_content(const Layout &l, XmlWriter &w) const final { static_cast<const Derived &>(*this).emit_content(l, w); }
+        void write_content(const Layout &l, XmlBuilder &w) const final { static_cast<const Derived &>(*this).emit_content(l, w); }
+        void write_content(const Layout &l, pmr::XmlBuilder &w) const final { static_cast<const Derived &>(*this).emit_content(l, w); }
+    };
+
+    class FlatRender final : public StyledRender<FlatRender> {
+        friend class Render;
+        friend StyledRender;
 
     public:
-        using Render::Render;
+        static constexpr RenderTraits TRAITS{20, 0, true, true};
+
+    private:
+        template<typename Writer>
+        void emit_content(const Layout &l, Writer &w) const;
     };
+    class FlatSquareRender final : public StyledRender<FlatSquareRender> {
+        friend class Render;
+        friend StyledRender;
 
-    class ForTheBadgeRender final : public Render {
-    protected:
-        [[nodiscard]] unsigned int get_height() const override;
-        [[nodiscard]] Xml get_content() const override;
-        [[nodiscard]] unsigned int get_vertical_margin() const override;
-        [[nodiscard]] bool text_has_shadow() const override;
-        unsigned int get_str_width(const std::optional<std::string> &str, TextType tt) const override;
+    public:
+        static constexpr RenderTraits TRAITS{20, 0, false, true};
 
-        Xml render() override;
+    private:
+        template<typename Writer>
+        void emit_content(const Layout &l, Writer &w) const;
+    };
+    class PlasticRender final : public StyledRender<PlasticRender> {
+        friend class Render;
+        friend StyledRender;
 
     public:
-        using Render::Render;
+        static constexpr RenderTraits TRAITS{18, static_cast<unsigned int>(-10), true, true};
 
     private:
-        unsigned int label_text_min_x;
-        unsigned int label_rect_width;
-        unsigned int message_text_min_x;
-        unsigned int message_rect_width;
+        template<typename Writer>
+        void emit_content(const Layout &l, Writer &w) const;
+    };
 
-        std::string up_label;
-        std::string up_message;
+    class ForTheBadgeRender final : public StyledRender<ForTheBadgeRender> {
+        friend class Render;
+        friend StyledRender;
 
-        [[nodiscard]] Xml getLabelElement() const;
-        [[nodiscard]] Xml getMessageElement() const;
-    };
+    public:
+        static constexpr RenderTraits TRAITS{28, 0, false, true};
 
-    class SocialRender final : public Render {
     protected:
-        [[nodiscard]] unsigned int get_height() const override;
-        [[nodiscard]] Xml get_content() const override;
-        [[nodiscard]] unsigned int get_vertical_margin() const override;
-        [[nodiscard]] bool text_has_shadow() const override;
-        unsigned int get_str_width(const std::optional<std::string> &str, TextType tt) const override;
+        unsigned int get_str_width(const Layout &l, const std::optional<std::string_view> &str, TextType tt) const override;
 
-        Xml render() override;
+    private:
+        void calcValues(Layout &l) const;
+        template<typename Writer>
+        void emit_content(const Layout &l, Writer &w) const;
+        template<typename Writer>
+        void writeLabelElement(const Layout &l, Writer &w) const;
+        template<typename Writer>
+        void writeMessageElement(const Layout &l, Writer &w) const;
+    };
+
+    class SocialRender final : public StyledRender<SocialRender> {
+        friend class Render;
+        friend StyledRender;
 
     public:
-        using Render::Render;
+        static constexpr RenderTraits TRAITS{20, 0, false, false};
 
-    private:
-        unsigned int label_rect_width;
-        unsigned int message_rect_width;
+    protected:
+        unsigned int get_str_width(const Layout &l, const std::optional<std::string_view> &str, TextType tt) const override;
 
-        [[nodiscard]] Xml getMessageBubble() const;
-        [[nodiscard]] Xml getLabelText() const;
-        [[nodiscard]] Xml getMessageText() const;
+    private:
+        void calcValues(Layout &l) const;
+        template<typename Writer>
+        void emit_content(const Layout &l, Writer &w) const;
+        template<typename Writer>
+        void writeMessageBubble(const Layout &l, Writer &w) const;
+        template<typename Writer>
+        void writeLabelText(const Layout &l, Writer &w) const;
+        template<typename Writer>
+        void writeMessageText(const Layout &l, Writer &w) const;
     };
 
 }// namespace badge
@@ -6,11 +6,44 @@
 #define BADGECPP_UTIL_HPP_GUARD
 
 
+#include <charconv>
+#include <cstddef>
 #include <string>
+#include <string_view>
+#include <type_traits>
 namespace badge {
 
+    /// @brief 坐标等数值格式化: 四舍五入到 p 位小数, 去掉末尾的0 (3.50 -> "3.5", 3.00 -> "3")
     std::string dtos(double d, int p = 2);
 
+    /// @brief 栈上格式化的数字字符串, 基于 std::to_chars, 不分配内存
+    /// @details 用于渲染时的数值属性, 代替 std::to_string / dtos 产生的临时 std::string.
+    ///          结果只在对象生命周期内有效, 通常直接作为 XmlTemplate 的填充值.
+    class NumberString final {
+    public:
+        static constexpr std::size_t CAPACITY = 48;
+
+        /// @brief 整数, 与 std::to_string 相同
+        template<typename T, std::enable_if_t<std::is_integral_v<T>, int> = 0>
+        explicit NumberString(T value) noexcept {
+            length_ = static_cast<std::size_t>(std::to_chars(buffer_, buffer_ + CAPACITY, value).ptr - buffer_);
+        }
+        /// @brief 浮点数, 与 std::to_string(double) 相同 (定点6位小数)
+        /// @note 超出缓冲区的极大值退化为最短表示
+        explicit NumberString(double value) noexcept;
+
+        /// @brief 四舍五入到 p 位小数并去掉末尾的0, 与 dtos(d, p) 相同
+        static NumberString trimmed(double d, int p = 2) noexcept;
+
+        [[nodiscard]] std::string_view view() const noexcept { return {buffer_, length_}; }
+        operator std::string_view() const noexcept { return view(); }
+
+    private:
+        NumberString() noexcept = default;
+        char buffer_[CAPACITY];
+        std::size_t length_ = 0;
+    };
+
     std::string toUpperCase(std::string str);
     std::string toLowerCase(std::string str);
 
@@ -4,9 +4,13 @@
 /// Licence: MIT
 #ifndef BADGECPP_XML_HPP_GUARD
 #define BADGECPP_XML_HPP_GUARD
+#include <cstddef>
+#include <initializer_list>
 #include <memory>
+#include <memory_resource>
 #include <ostream>
 #include <string>
+#include <string_view>
 #include <type_traits>
 #include <utility>
 #include <variant>
@@ -90,10 +94,16 @@ namespace badge {
         /// @brief 将XML节点渲染到输出流
         void render(std::ostream &os) const;
 
+        /// @brief 将XML节点渲染到缓冲区末尾, 会预先计算并预留所需空间
+        void render(std::string &out) const;
+
         /// @brief 将XML节点渲染为字符串
-        /// @see render(std::ostream &os) const
+        /// @see render(std::string &out) const
         [[nodiscard]] std::string render() const;
 
+        /// @brief 计算渲染结果的字节数, 不实际渲染
+        [[nodiscard]] size_t renderSize() const;
+
         /// @brief 判断本节点(及所有子节点)是否为空
         [[nodiscard]] bool isEmpty() const;
         /// @brief 判断所有子节点是否为空
@@ -106,7 +116,232 @@ namespace badge {
         static std::variant<std::shared_ptr<Xml>, std::string> make_sub(const Xml &sub) { return std::make_shared<Xml>(sub); }
         static std::variant<std::shared_ptr<Xml>, std::string> make_sub(const std::shared_ptr<Xml> &sub) { return sub; }
         static std::variant<std::shared_ptr<Xml>, std::string> make_sub(const std::string &sub) { return sub; }
-        static void escape_xml(std::ostream &os, const std::string &str);
+        void render_to(std::string &out) const;
+    };
+
+    /// @brief 预编译的XML片段模板: 常量字节块加上带类型的空洞
+    /// @details 模板由一段已是最终输出形式的XML片段编译而来, 其中 $0 ~ $9 表示空洞, 引用填充时传入的第N个值.
+    ///          字符串值会被转义, 整数值直接格式化. 空洞只能出现在属性值和文本中.
+    ///          片段可以以未闭合的起始标签结尾(没有 '>'), 之后的内容由写出器继续写入, 空内容时自动输出自闭合标签.
+    ///          片段不能以结束标签开头, 也不能包含需要转义的字符.
+    ///          XmlWriter 直接按块复制; 其他写出器按编译时解析出的 open/attr/text/close 序列回放.
+    class XmlTemplate {
+    public:
+        /// @brief 空洞的值
+        using Value = std::variant<std::string_view, unsigned int>;
+
+    private:
+        /// @brief 常量字节块或空洞
+        struct Piece {
+            size_t offset;///< 常量在 pattern_ 中的偏移
+            size_t length;///< 常量长度
+            int hole;     ///< 空洞编号, -1 表示常量
+        };
+        /// @brief 回放操作
+        struct Op {
+            enum Kind {
+                OPEN,
+                ATTR,
+                TEXT,
+                CLOSE,
+            } kind;
+            size_t offset;           ///< 节点名称/属性名在 pattern_ 中的偏移
+            size_t length;           ///< 节点名称/属性名长度
+            std::vector<Piece> value;///< 属性值/文本
+        };
+
+        std::string pattern_;      ///< 模板原文
+        std::vector<Piece> pieces_;///< 按输出顺序排列的字节块与空洞
+        std::vector<Op> ops_;      ///< 回放序列
+        bool open_at_end_ = false; ///< 是否以未闭合的起始标签结尾
+        int holes_ = 0;            ///< 所需值的个数
+
+        friend class XmlWriter;
+
+    public:
+        /// @brief 编译模板
+        /// @throws std::invalid_argument 模板格式错误
+        explicit XmlTemplate(std::string_view pattern);
+
+        /// @brief 是否以未闭合的起始标签结尾
+        [[nodiscard]] bool openAtEnd() const { return open_at_end_; }
+        /// @brief 填充时所需值的个数
+        [[nodiscard]] int holes() const { return holes_; }
+
+        /// @brief 以 open/attr/text/close 序列将模板回放到任意写出器
+        /// @details 由多段拼接的属性值/文本在栈上的缓冲区中拼接, 超出 SCRATCH_SIZE 时才从 upstream 分配
+        /// @param upstream 拼接缓冲区不足时使用的 memory_resource
+        template<typename Writer>
+        void replay(Writer &w, std::initializer_list<Value> values, std::pmr::memory_resource *upstream = std::pmr::get_default_resource()) const {
+            check(values);
+            std::byte stack[SCRATCH_SIZE];
+            std::pmr::monotonic_buffer_resource scratch{stack, sizeof(stack), upstream};
+            std::pmr::string buf{&scratch};
+            for (const auto &op: ops_) {
+                const std::string_view name{pattern_.data() + op.offset, op.length};
+                switch (op.kind) {
+                        // clang-format off
+                    case Op::OPEN:  w.open(name); break;
+                    case Op::ATTR:  w.attr(name, assemble(buf, op.value, values)); break;
+                    case Op::TEXT:  w.text(assemble(buf, op.value, values)); break;
+                    case Op::CLOSE: w.close(name); break;
+                        // clang-format on
+                }
+            }
+        }
+
+    private:
+        /// @brief 回放时栈上拼接缓冲区的大小, 足够容纳徽章中由多段拼接的属性值
+        static constexpr size_t SCRATCH_SIZE = 256;
+
+        /// @brief 拼接常量与空洞值 (不转义), 只有一段时直接返回其视图
+        std::string_view assemble(std::pmr::string &buf, const std::vector<Piece> &value, std::initializer_list<Value> values) const;
+        /// @throws std::invalid_argument 值的个数不足
+        void check(std::initializer_list<Value> values) const;
+    };
+
+    /// @brief XML流式写出器, 直接将节点写入调用者提供的缓冲区, 不构建节点树
+    /// @details 输出与 Xml::render 逐字节一致: 没有任何非空内容的节点输出为自闭合标签,
+    ///          空文本不会被写出. 调用者负责保证 open/close 成对出现.
+    class XmlWriter {
+        std::string &out_;   ///< 输出缓冲区
+        bool pending_ = false;///< 当前节点的起始标签尚未闭合 (还没有写入非空内容)
+
+    public:
+        /// @param out 输出缓冲区, 写出的内容会追加到末尾
+        explicit XmlWriter(std::string &out) : out_(out) {}
+
+        /// @brief 开始一个节点
+        XmlWriter &open(std::string_view name);
+        /// @brief 为当前节点添加一条属性, 只能在 open 之后, 写入任何内容之前调用
+        XmlWriter &attr(std::string_view key, std::string_view value);
+        /// @brief 写入文本内容, 空文本不会产生任何输出
+        XmlWriter &text(std::string_view text);
+        /// @brief 结束一个节点
+        /// @param name 节点名称, 必须与对应的 open 一致
+        XmlWriter &close(std::string_view name);
+        /// @brief 按块复制模板, 空洞处写入格式化后的值
+        XmlWriter &fill(const XmlTemplate &tpl, std::initializer_list<XmlTemplate::Value> values);
+
+        /// @brief 获取输出缓冲区
+        [[nodiscard]] std::string &buffer() { return out_; }
+
+    private:
+        void flush_pending();
     };
+
+    /// @brief 以 XmlWriter 相同的接口构建 Xml 节点树
+    /// @details 第一个 open 的节点即为根节点本身, 之后 open 的节点作为当前节点的子节点.
+    ///          节点的属性与内容先缓存在所在层, close 时才按精确大小创建节点, 各层的缓存在之后的节点间复用.
+    class XmlBuilder {
+        /// @brief 一个打开的节点
+        struct Frame {
+            std::string name;
+            Xml::Attrs attrs;
+            Xml::Contents contents;
+        };
+        /// @brief 每层缓存的初始容量, 足够容纳徽章中单个节点的属性与内容
+        static constexpr size_t FRAME_RESERVE = 8;
+        Xml &root_;
+        std::vector<Frame> frames_;///< 按深度排列, 关闭的层保留容量
+        size_t depth_ = 0;         ///< 当前打开的节点个数
+
+    public:
+        /// @param root 根节点, 在根节点 close 时被赋值
+        explicit XmlBuilder(Xml &root) : root_(root) { frames_.reserve(FRAME_RESERVE); }
+
+        XmlBuilder &open(std::string_view name);
+        XmlBuilder &attr(std::string_view key, std::string_view value);
+        XmlBuilder &text(std::string_view text);
+        XmlBuilder &close(std::string_view name);
+        XmlBuilder &fill(const XmlTemplate &tpl, std::initializer_list<XmlTemplate::Value> values);
+    };
+
+    namespace pmr {
+        /// @brief 使用 std::pmr::memory_resource 分配的XML节点
+        /// @details 节点本身, 子节点, 属性与文本均从同一个 memory_resource 中分配, 子节点以裸指针持有, 没有引用计数.
+        ///          配合 std::pmr::monotonic_buffer_resource 使用时, 整棵树可以在一块缓冲区内构建并一次性释放.
+        ///          渲染结果与 badge::Xml 一致.
+        /// @note memory_resource 的生命周期必须长于节点树
+        class Xml {
+        public:
+            using allocator_type = std::pmr::polymorphic_allocator<std::byte>;
+            /// @brief 节点名称类型
+            using Name = std::pmr::string;
+            /// @brief 属性类型
+            using Attr = std::pair<std::pmr::string, std::pmr::string>;
+            /// @brief 属性集合
+            using Attrs = std::pmr::vector<Attr>;
+            /// @brief 节点内容类型, 子节点由本节点持有
+            using Content = std::variant<Xml *, std::pmr::string>;
+            /// @brief 节点内容集合
+            using Contents = std::pmr::vector<Content>;
+
+        private:
+            Name name_;       ///< 节点名称
+            Attrs attr_;      ///< 节点属性
+            Contents content_;///< 节点内容
+
+        public:
+            /// @brief 空构造, 将不会被渲染进最终结果
+            explicit Xml(allocator_type alloc = {});
+            /// @param name 节点名称, 为空代表这是一个list, 本身不会渲染, 只渲染内容
+            explicit Xml(std::string_view name, allocator_type alloc = {});
+            Xml(Xml &&other) noexcept;
+            Xml(const Xml &) = delete;
+            Xml &operator=(const Xml &) = delete;
+            Xml &operator=(Xml &&) = delete;
+            ~Xml();
+
+            [[nodiscard]] allocator_type get_allocator() const { return name_.get_allocator(); }
+
+            /// @brief 设置节点名称, 为空代表这是一个list, 本身不会渲染, 只渲染内容
+            Xml &setName(std::string_view name);
+            /// @brief 添加一条属性
+            Xml &addAttr(std::string_view key, std::string_view value);
+            /// @brief 添加一段文本内容
+            Xml &addContent(std::string_view text);
+            /// @brief 在同一个 memory_resource 中创建一个子节点并添加到内容末尾
+            /// @return 新建的子节点
+            Xml &addNode(std::string_view name);
+
+            [[nodiscard]] const Name &name() const { return name_; }
+            [[nodiscard]] const Attrs &attrs() const { return attr_; }
+            [[nodiscard]] const Contents &contents() const { return content_; }
+
+            /// @brief 将XML节点渲染到输出流
+            void render(std::ostream &os) const;
+            /// @brief 将XML节点渲染到缓冲区末尾
+            void render(std::string &out) const;
+            /// @brief 将XML节点渲染为字符串
+            [[nodiscard]] std::string render() const;
+
+            /// @brief 判断本节点(及所有子节点)是否为空
+            [[nodiscard]] bool isEmpty() const;
+            /// @brief 判断所有子节点是否为空
+            [[nodiscard]] bool isSubEmpty() const;
+
+        private:
+            void render_to(std::string &out) const;
+        };
+
+        /// @brief 以 XmlWriter 相同的接口构建 pmr::Xml 节点树
+        /// @details 第一个 open 的节点即为根节点本身, 之后 open 的节点作为当前节点的子节点
+        class XmlBuilder {
+            Xml &root_;
+            std::pmr::vector<Xml *> stack_;///< 当前打开的节点
+
+        public:
+            /// @param root 根节点, 所有节点都从其 memory_resource 中分配
+            explicit XmlBuilder(Xml &root) : root_(root), stack_(root.get_allocator()) {}
+
+            XmlBuilder &open(std::string_view name);
+            XmlBuilder &attr(std::string_view key, std::string_view value);
+            XmlBuilder &text(std::string_view text);
+            XmlBuilder &close(std::string_view name);
+                /// @brief 回放模板, 拼接缓冲区不足时从根节点的 memory_resource 分配
+            XmlBuilder &fill(const XmlTemplate &tpl, std::initializer_list<XmlTemplate::Value> values);
+        };
+    }// namespace pmr
 }// namespace badge
 #endif// BADGECPP_XML_HPP_GUARD
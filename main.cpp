@@ -1,8 +1,25 @@
+#include "badgecpp/alloc_stats.hpp"
 #include "badgecpp/badge.hpp"
+#include "badgecpp/batch.hpp"
+#include "badgecpp/cache.hpp"
+#include "badgecpp/font.hpp"
 #include "badgecpp/icons.hpp"
+#include "badgecpp/metrics.hpp"
+#include "badgecpp/render.hpp"
+#include "badgecpp/util.hpp"
 #include "badgecpp/xml.hpp"
+#include <algorithm>
+#include <array>
 #include <fstream>
+#include <iostream>
+#include <memory_resource>
 #include <optional>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+/// @brief 统计堆分配, 用于检查渲染路径的分配次数
+BADGECPP_COUNTING_OPERATOR_NEW();
 
 static const auto LOGO = badge::BuiltinIcons::by_title("C++");
 badge::Xml makeSome(badge::Style style) {
@@ -59,9 +76,457 @@ badge::Xml makeSome(badge::Style style) {
             Xml{"td", logo_label_msg},
     };
 }
+/// @brief 检查模板流式输出, Xml树输出, pmr树输出与虚函数分派的输出是否逐字节一致
+bool checkRenderPaths(badge::Style style) {
+    using namespace badge;
+    Badge svg{"label<&>", std::nullopt, "message\"'", std::nullopt, style, LOGO, std::nullopt, std::nullopt, "check"};
+    std::pmr::monotonic_buffer_resource arena;
+    const auto stream = svg.makeBadge();
+    const Render &render = Render::get(style);
+    const Layout layout = render.layout(svg.view());
+    std::string streamed, bound;
+    render.render(layout, streamed);
+    Render::create(svg)->render(bound);
+    if (stream != svg.makeBadgeXml().render() || stream != svg.makeBadgeXml(&arena).render() ||
+        stream != render.render(layout).render() || stream != streamed || &render != &Render::get(style) ||
+        stream != Render::create(svg)->render().render() || stream != bound) {
+        std::cerr << "render paths differ for style " << style_str(style) << std::endl;
+        return false;
+    }
+    return true;
+}
+/// @brief 检查直接引用外部缓冲区的 BadgeView 与拥有文字的 Badge 渲染结果一致
+bool checkBadgeView(badge::Style style) {
+    using namespace badge;
+    const std::string request = "label=构建 <状态>&message=passing \"all\"&id=view";
+    const std::string_view buffer = request;
+    const auto field = [buffer](std::string_view key) {
+        const auto begin = buffer.find(key) + key.size();
+        return buffer.substr(begin, buffer.find('&', begin) - begin);
+    };
+    const auto label = field("label="), message = field("message="), id = field("id=");
+    const BadgeView views[] = {
+            {label, Color{"#08c"}, message, std::nullopt, style, LOGO.get(), Color{"white"}, 20, id},
+            {std::nullopt, std::nullopt, message, Color{"red"}, style, nullptr, std::nullopt, std::nullopt, id},
+            {label, std::nullopt, std::nullopt, std::nullopt, style, LOGO.get(), std::nullopt, std::nullopt, std::nullopt},
+    };
+    for (const auto &view: views) {
+        Badge badge{std::nullopt, view.label_color_, std::nullopt, view.message_color_, style, LOGO, view.logo_color_, view.logo_width_};
+        if (view.label_) badge.label_ = std::string{*view.label_};
+        if (view.message_) badge.message_ = std::string{*view.message_};
+        if (view.id_suffix_) badge.id_suffix_ = std::string{*view.id_suffix_};
+        if (!view.logo_) badge.logo_ = nullptr;
+        std::pmr::monotonic_buffer_resource arena;
+        const auto expected = badge.makeBadge();
+        if (view.makeBadge() != expected || view.makeBadgeXml().render() != expected || view.makeBadgeXml(&arena).render() != expected) {
+            std::cerr << "badge view output differs for style " << style_str(style) << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+/// @brief 去掉小数末尾的0 (41.500000 -> 41.5, 3.000000 -> 3)
+/// @details 基准输出中的坐标由 std::to_string(double) 格式化, 这是它与当前坐标格式的唯一差别
+std::string trimDecimalZeros(std::string_view svg) {
+    const auto digit = [](char ch) { return ch >= '0' && ch <= '9'; };
+    std::string out;
+    out.reserve(svg.size());
+    for (size_t i = 0; i < svg.size();) {
+        if (svg[i] == '.' && i > 0 && digit(svg[i - 1]) && i + 1 < svg.size() && digit(svg[i + 1])) {
+            size_t end = i + 1;
+            while (end < svg.size() && digit(svg[end])) ++end;
+            size_t keep = end;
+            while (keep > i + 1 && svg[keep - 1] == '0') --keep;
+            if (keep > i + 1) out.append(svg.substr(i, keep - i));
+            i = end;
+        } else {
+            out += svg[i++];
+        }
+    }
+    return out;
+}
+/// @brief 检查各样式的输出与 test/fixtures/render_baseline.txt 一致
+/// @details 基准文件由重构前的渲染器 (Xml 节点树) 生成, 每条记录为 "样式/用例" 与 svg 两行;
+///          logo 使用固定的测试图标, 不依赖 simple-icons 的版本. 比较前只做 trimDecimalZeros 的归一化.
+bool checkBaselineFixtures(badge::Style style) {
+    using namespace badge;
+    static const auto fixtures = [] {
+        std::vector<std::pair<std::string, std::string>> records;
+        std::ifstream in{BADGECPP_TEST_FIXTURES "/render_baseline.txt"};
+        for (std::string name, svg; std::getline(in, name) && std::getline(in, svg);) records.emplace_back(std::move(name), trimDecimalZeros(svg));
+        return records;
+    }();
+    static const auto icon = std::make_shared<const BuiltinIcon>(
+            "Test", Color{"#00599c"},
+            R"(<svg role="img" viewBox="0 0 24 24" xmlns="http://www.w3.org/2000/svg"><title>Test</title><path d="M12 0 24 12 12 24 0 12z"/></svg>)");
+    const std::pair<std::string_view, Badge> cases[] = {
+            {"label_message", Badge{"build", std::nullopt, "passing", std::nullopt, style, nullptr, std::nullopt, std::nullopt, "a"}},
+            {"message", Badge{std::nullopt, std::nullopt, "passing", std::nullopt, style, nullptr, std::nullopt, std::nullopt, "b"}},
+            {"label", Badge{"build", std::nullopt, std::nullopt, std::nullopt, style, nullptr, std::nullopt, std::nullopt, "c"}},
+            {"colors", Badge{"coverage", Color{"#fff"}, "97%", Color{"red"}, style, nullptr, std::nullopt, std::nullopt, "d"}},
+            {"logo", Badge{"language", std::nullopt, "C++17", Color{"blue"}, style, icon, std::nullopt, std::nullopt, "e"}},
+            {"logo_only", Badge{std::nullopt, std::nullopt, std::nullopt, std::nullopt, style, icon, Color{"#fff"}, 20, "f"}},
+            {"escape", Badge{"a<b>&\"c'", std::nullopt, "x & y", std::nullopt, style, nullptr, std::nullopt, std::nullopt, std::nullopt}},
+            {"cjk", Badge{"构建状态", std::nullopt, "通过", std::nullopt, style, nullptr, std::nullopt, std::nullopt, "g"}},
+    };
+    for (const auto &[name, badge]: cases) {
+        const auto key = std::string{style_str(style)} + "/" + std::string{name};
+        const auto fixture = std::find_if(fixtures.begin(), fixtures.end(), [&key](const auto &record) { return record.first == key; });
+        if (fixture == fixtures.end()) {
+            std::cerr << "missing baseline fixture " << key << std::endl;
+            return false;
+        }
+        std::pmr::monotonic_buffer_resource arena;
+        const auto stream = badge.makeBadge();
+        if (stream != fixture->second || badge.makeBadgeXml().render() != fixture->second || badge.makeBadgeXml(&arena).render() != fixture->second) {
+            std::cerr << "output differs from baseline fixture " << key << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+/// @brief 检查 NumberString 的格式化结果
+bool checkNumberString() {
+    using namespace badge;
+    for (int i = -2000; i <= 2000; ++i) {
+        const double d = i * 0.37 + 0.5;
+        if (NumberString(i).view() != std::to_string(i) ||
+            NumberString(static_cast<unsigned int>(i + 2000)).view() != std::to_string(static_cast<unsigned int>(i + 2000)) ||
+            NumberString(d).view() != std::to_string(d) ||
+            NumberString::trimmed(d).view() != dtos(d)) {
+            std::cerr << "NumberString mismatch at " << i << std::endl;
+            return false;
+        }
+    }
+    // 四舍五入而不是截断, 去掉末尾的0, 不输出 "-0"
+    const std::pair<double, std::string_view> cases[] = {
+            {0.29, "0.29"}, {123.5, "123.5"}, {3.0, "3"}, {99.999, "100"}, {0.1 + 0.2, "0.3"},
+            {-1.25, "-1.25"}, {-0.001, "0"}, {1e-9, "0"}, {0, "0"}, {1e30, "1000000000000000019884624838656"},
+    };
+    for (const auto &[d, expected]: cases) {
+        if (NumberString::trimmed(d).view() != expected) {
+            std::cerr << "NumberString::trimmed(" << d << ") = " << NumberString::trimmed(d).view() << ", expected " << expected << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+/// @brief 颜色解析语料: 每种语法的合法输入与边界/畸形输入, 也作为变异测试的种子
+static const std::pair<std::string_view, std::optional<std::array<uint8_t, 4>>> COLOR_CORPUS[] = {
+        {"#fff", {{255, 255, 255, 255}}},
+        {"#A1b2C3", {{161, 178, 195, 255}}},
+        {"  #08c\t", {{0, 136, 204, 255}}},
+        {"#12345", std::nullopt},
+        {"#12 345", std::nullopt},
+        {"#+12345", std::nullopt},
+        {"#ggg", std::nullopt},
+        {"rgb(1,2,3)", {{1, 2, 3, 255}}},
+        {"rgb( 10 , +20 ,30 )", {{10, 20, 30, 255}}},
+        {"rgb(256,0,0)", std::nullopt},
+        {"rgb(-1,0,0)", std::nullopt},
+        {"rgb(1,2,3)x)", std::nullopt},
+        {"rgb(1,2,3,4)", std::nullopt},
+        {"rgb(1.5,2,3)", std::nullopt},
+        {"rgba(1,2,3,0.5)", {{1, 2, 3, 128}}},
+        {"rgba(1,2,3,.2)", {{1, 2, 3, 51}}},
+        {"rgba(1,2,3,1e-1)", {{1, 2, 3, 26}}},
+        {"rgba(1,2,3,1.01)", std::nullopt},
+        {"rgba(1,2,3,nan)", std::nullopt},
+        {"rgba(1,2,3)", std::nullopt},
+        {"hsl(120,50%,50%)", {{63, 191, 63, 255}}},
+        {"hsl(360,100%,100%)", {{255, 255, 255, 255}}},
+        {"hsl(361,0%,0%)", std::nullopt},
+        {"hsl(0,50,50%)", std::nullopt},
+        {"hsla(240, 100%, 25%, .3)", {{0, 0, 127, 77}}},
+        {"hsla(240,100%,25%)", std::nullopt},
+        {"red", {{255, 0, 0, 255}}},
+        {"aliceblue", {{240, 248, 255, 255}}},
+        {"hotpink", {{255, 105, 180, 255}}},
+        {"transparent", {{0, 0, 0, 0}}},
+        {"currentColor", std::nullopt},// 无法用 RGBA 表示, 见 checkColors
+        {"Red", std::nullopt},
+        {"rgbred", std::nullopt},
+        {"", std::nullopt},
+        {"(", std::nullopt},
+        {"rgb(", std::nullopt},
+};
+/// @brief 检查颜色解析: 语料的期望结果; 对语料做随机变异, 解析不能分配内存, 成功的结果经 to_str 往返不变
+bool checkColors() {
+    using namespace badge;
+    for (const auto &[input, expected]: COLOR_CORPUS) {
+        std::array<uint8_t, 4> v{0, 0, 0, 255};
+        const bool ok = Color::parseString(input, v);
+        if (ok != expected.has_value() || (ok && v != *expected)) {
+            std::cerr << "color parse mismatch: \"" << input << "\"" << std::endl;
+            return false;
+        }
+    }
+
+    // 序列化取最短的名字, 等长取字母序靠前的
+    const std::pair<Color, std::string_view> names[] = {
+            {Color{"grey"}, "gray"}, {Color{"#0ff"}, "#0FF"}, {Color{"#f00"}, "red"}, {Color{"#F0F"}, "#F0F"},
+            {Color{"rgba(0,0,0,0)"}, "transparent"}, {Color{" currentColor "}, "currentColor"}, {Color{"#123456"}, "#123456"},
+    };
+    for (const auto &[color, expected]: names) {
+        if (color.to_str() != expected) {
+            std::cerr << "color to_str mismatch: " << color.to_str() << ", expected " << expected << std::endl;
+            return false;
+        }
+    }
+    if (Color{"currentColor"} == Color{"black"} || Color{"cyan"}.name() != "aqua" || Color{"#010203"}.name()) return false;
+
+    std::vector<std::string> inputs;
+    uint32_t seed = 1;
+    const auto next = [&seed](uint32_t n) { return (seed = seed * 1103515245 + 12345) / 65536 % n; };
+    constexpr std::string_view alphabet = "0123456789abcdefABCDEF#(),.% +-rgbhslaxe\t";
+    for (int i = 0; i < 20000; ++i) {
+        std::string s{COLOR_CORPUS[next(std::size(COLOR_CORPUS))].first};
+        for (auto edits = 1 + next(3); edits > 0; --edits) {
+            const auto pos = next(static_cast<uint32_t>(s.size() + 1));
+            const char c = alphabet[next(alphabet.size())];
+            switch (next(3)) {
+                case 0: if (pos < s.size()) s[pos] = c; break;
+                case 1: s.insert(s.begin() + pos, c); break;
+                default: if (pos < s.size()) s.erase(pos, 1); break;
+            }
+        }
+        inputs.push_back(std::move(s));
+    }
+    std::vector<std::array<uint8_t, 4>> results(inputs.size());
+    std::vector<char> parsed(inputs.size());
+    const auto parsing = alloc_stats::measure([&] {
+        for (size_t i = 0; i < inputs.size(); ++i) parsed[i] = Color::parseString(inputs[i], results[i]);
+    });
+    if (parsing.allocations != 0) {
+        std::cerr << "color parsing allocated memory" << std::endl;
+        return false;
+    }
+    // 半透明颜色与过长的 css 原文 (ResolvedColor 回退到序列化形式)
+    if (Color{0, 136, 204, 128}.to_str() != "rgba(0,136,204,.5019)" || Color{0, 0, 0, 0}.to_str() != "transparent" ||
+        ResolvedColor{"rgba(  0, 136, 204, 0.50196078 )"}.str() != "rgba(0,136,204,.5019)" || ResolvedColor{"#4c1"}.str() != "#4c1") {
+        std::cerr << "translucent color serialization mismatch" << std::endl;
+        return false;
+    }
+    for (size_t i = 0; i < inputs.size(); ++i) {
+        if (!parsed[i] || results[i][3] != 255) continue;
+        Color color;
+        color.value = results[i];
+        if (Color{color.to_str()} != color) {
+            std::cerr << "color round trip failed: \"" << inputs[i] << "\" -> " << color.to_str() << std::endl;
+            return false;
+        }
+        const ResolvedColor resolved{color};
+        if (resolved.str() != color.to_str() || resolved.brightness != color.brightness() ||
+            std::pair{resolved.text, resolved.shadow} != color.getTextColorsForBackground()) {
+            std::cerr << "resolved color mismatch: " << color.to_str() << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+/// @brief 各样式每次调用的堆分配次数上界
+/// @details stream 与 pmr 路径保证不分配, 上界为 0; string 与 tree 在 libstdc++ (短字符串优化 15字节) 的实测值上留约 10% 余量,
+///          以适应不同的标准库实现, 只防止明显的回退
+struct AllocationBounds {
+    badge::Style style;
+    size_t stream;///< Badge 与 BadgeView 的 makeBadge(out), 输出缓冲区已预留
+    size_t string;///< makeBadge()
+    size_t tree;  ///< makeBadgeXml()
+    size_t pmr;   ///< makeBadgeXml(&arena), arena 使用栈上缓冲区
+};
+constexpr AllocationBounds ALLOCATION_BOUNDS[] = {
+        {badge::FLAT, 0, 8, 62, 0},
+        {badge::FLAT_SQUARE, 0, 8, 40, 0},
+        {badge::PLASTIC, 0, 8, 68, 0},
+        {badge::FOR_THE_BADGE, 0, 8, 40, 0},
+        {badge::SOCIAL, 0, 8, 75, 0},
+};
+/// @brief 每条渲染路径的堆分配次数, 超过上界时报错
+bool checkAllocations(const AllocationBounds &bounds) {
+    using namespace badge;
+    const Badge svg{"build status", Color{"rgba(0,136,204,0.5)"}, "passing", Color{"green"}, bounds.style, LOGO, std::nullopt, std::nullopt, "allocations-check"};
+    std::string out;
+    out.reserve(1 << 16);
+    svg.makeBadge(out);// 预热字体, 图标uri缓存等
+    alignas(std::max_align_t) std::byte buffer[1 << 15];
+    const auto check = [&](const char *path, size_t limit, auto &&call) {
+        const auto report = alloc_stats::measure(call);
+        if (report.allocations <= limit) return true;
+        std::cerr << "too many allocations for style " << style_str(bounds.style) << " (" << path << "): "
+                  << report << ", limit " << limit << std::endl;
+        return false;
+    };
+    const BadgeView view = svg.view();
+    return check("stream", bounds.stream, [&] { out.clear(); svg.makeBadge(out); }) &&
+           check("view", bounds.stream, [&] { out.clear(); view.makeBadge(out); }) &&
+           check("string", bounds.string, [&] { (void) svg.makeBadge(); }) &&
+           check("tree", bounds.tree, [&] { (void) svg.makeBadgeXml(); }) &&
+           check("pmr", bounds.pmr, [&] {
+               std::pmr::monotonic_buffer_resource arena{buffer, sizeof buffer, std::pmr::null_memory_resource()};
+               (void) svg.makeBadgeXml(&arena);
+           });
+}
+/// @brief Color::to_str 与 Font::toU32String 的堆分配次数
+bool checkHelperAllocations() {
+    using namespace badge;
+    const Color named{"green"}, hex{"#123456"}, rgba{"rgba(0,136,204,0.5)"};
+    const std::string text = "continuous integration pipeline";
+    std::string str;
+    const auto short_str = alloc_stats::measure([&] { str = named.to_str(); str = hex.to_str(); });
+    const auto long_str = alloc_stats::measure([&] { (void) rgba.to_str(); });
+    const auto u32 = alloc_stats::measure([&] { (void) Font::toU32String(text); });
+    if (short_str.allocations == 0 && long_str.allocations <= 1 && u32.allocations <= 1) return true;
+    std::cerr << "allocations (to_str short): " << short_str << ", (to_str rgba): " << long_str << ", (toU32String): " << u32 << std::endl;
+    return false;
+}
+/// @brief 检查缓存命中与淘汰
+bool checkCache() {
+    using namespace badge;
+    BadgeCache cache{2, 1};
+    Badge a{"cache", std::nullopt, "a", std::nullopt, FLAT, LOGO, std::nullopt, std::nullopt, "a"};
+    Badge b = a, c = a;
+    b.message_ = "b";
+    c.message_ = "c";
+    const auto first = cache.get(a);
+    if (*first != a.makeBadge() || cache.get(a) != first) return false;
+    (void) cache.get(b);
+    (void) cache.get(c);// 淘汰 b (a 刚被引用过)
+    const auto stats = cache.stats();
+    if (stats.hits != 1 || stats.misses != 3 || stats.evictions != 1 || stats.size != 2) return false;
+    return cache.find(a) == first && cache.find(b) == nullptr;
+}
+/// @brief 检查内置字体(编译期查找表)与运行时构建的字体
+bool checkFonts() {
+    using namespace badge;
+    const Font *builtin = Fonts::getBuiltin("verdana-11px-normal");
+    if (builtin == nullptr || Fonts::get("verdana-11px-normal") != builtin || Fonts::getDefault() != builtin) return false;
+    if (builtin->size() != 11 || builtin->emWidth() != builtin->widthOfCharCode(Font::GUESS_CHAR, false)) return false;
+    if (Fonts::getBuiltin("no-such-font") != nullptr || Fonts::getFonts().count("helvetica-11px-bold") != 1) return false;
+    const Font copy = Font::createByJsonString(std::string{"[[32,126,5],[19968,40959,11]]"}, 11);
+    return copy.widthOfString(std::string{"ab\xE4\xB8\x80"}) == 21 && copy.widthOfCharCode(0x10000, false) == -1;
+}
+/// @brief 检查延迟创建的内置图标与全量列表一致
+bool checkIcons() {
+    using namespace badge;
+    const auto icon = BuiltinIcons::by_title("C++");
+    if (icon == nullptr || icon != LOGO || BuiltinIcons::by_title("no such icon") != nullptr) return false;
+    if (BuiltinIcons::by_slug("cplusplus") != icon || BuiltinIcons::by_slug("C++") != nullptr) return false;
+    if (BuiltinIcons::by_title_nocase("c++") != icon || BuiltinIcons::lookup("cplusplus") != icon) return false;
+    const auto python = BuiltinIcons::by_title("Python");
+    if (python == nullptr || BuiltinIcons::lookup("PYTHON") != python) return false;
+    // 图标可以复制, 副本有独立的uri缓存与容量
+    BuiltinIcon copy = *python;
+    copy.set_uri_cache_capacity(0);
+    if (copy.uri_cache_capacity() != 0 || python->uri_cache_capacity() == 0 || *copy.get_uri_shared() != *python->get_uri_shared() ||
+        copy.get_uri_shared() == copy.get_uri_shared() || python->get_uri_shared() != python->get_uri_shared()) return false;
+    const auto completed = BuiltinIcons::complete("Py");
+    if (completed.size() != 1 || completed[0] != python || !BuiltinIcons::complete("zzz").empty()) return false;
+    const auto suggested = BuiltinIcons::suggest("pyhton");
+    if (suggested.empty() || suggested[0] != python || !BuiltinIcons::suggest("qqqqqqqq").empty()) return false;
+    // 编辑距离的边界: 0 即精确匹配, 过长的 name 直接返回空, 极大的 max_distance 命中全部图标
+    if (BuiltinIcons::suggest("python", 0).size() != 1 || BuiltinIcons::suggest("pytho", 0).size() != 0 ||
+        BuiltinIcons::suggest("ythn", 2).empty() || !BuiltinIcons::suggest(std::string(1 << 20, 'p')).empty() ||
+        BuiltinIcons::suggest("x", SIZE_MAX, SIZE_MAX).size() != BuiltinIcons::size()) return false;
+    warmup();
+    const auto &icons = BuiltinIcons::icons();
+    if (icons.size() != BuiltinIcons::size()) return false;
+    for (const auto &i: icons)
+        if (BuiltinIcons::by_title(i->title) != i) return false;
+    return std::find(icons.begin(), icons.end(), icon) != icons.end();
+}
+/// @brief 检查批量渲染(单线程与多线程)与逐个渲染一致
+bool checkBatch() {
+    using namespace badge;
+    std::vector<Badge> badges;
+    for (auto style: {FLAT, FLAT_SQUARE, PLASTIC, SOCIAL, FOR_THE_BADGE})
+        for (int i = 0; i < 40; ++i)
+            badges.push_back({"batch", std::nullopt, std::to_string(i), std::nullopt, style, i % 2 ? LOGO : nullptr, std::nullopt, std::nullopt, std::to_string(i)});
+    std::vector<BadgeView> views;
+    for (const auto &badge: badges) views.push_back(badge.view());
+    for (unsigned int threads: {1u, 4u}) {
+        const auto output = renderBatch(badges, {threads, 7});
+        const auto view_output = renderBatch(views, {threads, 7});
+        if (output.size() != badges.size() || output.offsets().back() != output.data().size()) return false;
+        if (view_output.data() != output.data() || view_output.offsets() != output.offsets()) return false;
+        for (size_t i = 0; i < badges.size(); ++i)
+            if (output[i] != badges[i].makeBadge()) return false;
+    }
+    return renderBatch(static_cast<const Badge *>(nullptr), 0).size() == 0;
+}
+/// @brief 检查分阶段统计: 开启时各渲染路径都被记录 (含已退出的线程), 关闭时快照为零
+bool checkMetrics() {
+    using namespace badge;
+    struct CountingSink final : metrics::Sink {
+        size_t renders = 0;
+        uint64_t bytes = 0;
+        void onRender(const metrics::RenderSample &sample) noexcept override {
+            ++renders;
+            bytes += sample.bytes;
+        }
+    } sink;
+    metrics::reset();
+    metrics::setSink(&sink);
+    const Badge svg{"metrics", std::nullopt, "check", std::nullopt, FLAT, LOGO, std::nullopt, std::nullopt, "metrics"};
+    std::pmr::monotonic_buffer_resource arena;
+    const auto stream = svg.makeBadge();
+    const auto tree = svg.makeBadgeXml().render();
+    const auto pmr_tree = svg.makeBadgeXml(&arena).render();
+    std::thread{[&svg] { (void) svg.makeBadge(); }}.join();
+    metrics::setSink(nullptr);
+
+    const auto s = metrics::snapshot();
+    const auto text = metrics::exposition(s);
+    if (text.find("# TYPE badgecpp_phase_duration_nanoseconds histogram") == std::string::npos ||
+        text.find("badgecpp_render_duration_nanoseconds_bucket{le=\"+Inf\"} " + std::to_string(s.render_ns.count) + "\n") == std::string::npos)
+        return false;
+    if constexpr (!metrics::enabled) return s.render_ns.count == 0 && sink.renders == 0;
+    using metrics::Phase;
+    return s.render_ns.count == 4 && sink.renders == 4 && sink.bytes == 2 * stream.size() &&
+           s.phase(Phase::CALC_VALUES).count == 4 && s.phase(Phase::WRITE_STREAM).count == 2 &&
+           s.phase(Phase::BUILD_TREE).count == 2 && s.phase(Phase::XML_RENDER).count == 2 &&
+           s.phase(Phase::ICON_URI).count == 4 && s.output_bytes.count == 4 &&
+           s.output_bytes.sum == stream.size() + tree.size() + pmr_tree.size() + stream.size() &&
+           s.output_nodes.sum % 4 == 0 && s.output_nodes.sum > 0;
+}
 int main() {
     using namespace badge;
 
+    if (!checkBatch()) {
+        std::cerr << "batch render check failed" << std::endl;
+        return 1;
+    }
+
+    if (!checkFonts()) {
+        std::cerr << "font check failed" << std::endl;
+        return 1;
+    }
+
+    if (!checkIcons()) {
+        std::cerr << "builtin icons check failed" << std::endl;
+        return 1;
+    }
+
+    if (!checkCache()) {
+        std::cerr << "badge cache check failed" << std::endl;
+        return 1;
+    }
+
+    for (auto style: {FLAT, FLAT_SQUARE, PLASTIC, SOCIAL, FOR_THE_BADGE})
+        if (!checkRenderPaths(style) || !checkBadgeView(style) || !checkBaselineFixtures(style)) return 1;
+
+    if (!checkNumberString()) return 1;
+    if (!checkColors()) return 1;
+    if (!checkMetrics()) {
+        std::cerr << "metrics check failed" << std::endl;
+        return 1;
+    }
+    for (const auto &bounds: ALLOCATION_BOUNDS)
+        if (!checkAllocations(bounds)) return 1;
+    if (!checkHelperAllocations()) {
+        std::cerr << "helper allocation check failed" << std::endl;
+        return 1;
+    }
+
     {
         std::ofstream("badgecpp.svg") << Badge{
                 "badge",
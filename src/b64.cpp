@@ -2,6 +2,13 @@
 #include <cstddef>
 #include <cstdint>
 #include <istream>
+#include <ostream>
+#include <string_view>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define BADGECPP_B64_X86 1
+#include <immintrin.h>
+#endif
 namespace {
 
     constexpr char alphabet_map[] =
@@ -16,45 +23,186 @@ namespace {
             25, 255, 255, 255, 255, 255, 255, 26, 27, 28, 29, 30, 31, 32, 33,
             34, 35, 36, 37, 38, 39, 40, 41, 42, 43, 44, 45, 46, 47, 48,
             49, 50, 51, 255, 255, 255, 255, 255};
-}// namespace
-namespace badge::b64 {
 
-    void b64encode(std::istream &in, std::ostream &out) {
-        constexpr size_t buffer_size = 3;
-        uint8_t buffer[buffer_size];
+    /// @brief 向量内核: 处理尽可能多的完整块, 返回已消耗的输入长度
+    /// @details 编码内核: 输入每3字节产生4字符; 解码内核: 遇到非法字符(含'=')时停止, 余下部分交给标量代码
+    using EncodeKernel = size_t (*)(const uint8_t *data, size_t dlen, char *out);
+    using DecodeKernel = size_t (*)(const uint8_t *data, size_t dlen, uint8_t *out);
 
-        while (in) {
-            in.read(reinterpret_cast<char *>(buffer), buffer_size);
-            const auto bytes_read = in.gcount();
-
-            if (bytes_read == 3) {
-                out.put(alphabet_map[buffer[0] >> 2]);
-                out.put(alphabet_map[((buffer[0] << 4) & 0x30) | (buffer[1] >> 4)]);
-                out.put(alphabet_map[((buffer[1] << 2) & 0x3C) | (buffer[2] >> 6)]);
-                out.put(alphabet_map[buffer[2] & 0x3F]);
-            } else if (bytes_read == 1) {
-                out.put(alphabet_map[buffer[0] >> 2]);
-                out.put(alphabet_map[(buffer[0] << 4) & 0x30]);
-                out.put('=');
-                out.put('=');
-            } else if (bytes_read == 2) {
-                out.put(alphabet_map[buffer[0] >> 2]);
-                out.put(alphabet_map[((buffer[0] << 4) & 0x30) | (buffer[1] >> 4)]);
-                out.put(alphabet_map[(buffer[1] << 2) & 0x3C]);
-                out.put('=');
-            } else
-                break;
+    size_t encode_none(const uint8_t *, size_t, char *) { return 0; }
+    size_t decode_none(const uint8_t *, size_t, uint8_t *) { return 0; }
+
+#ifdef BADGECPP_B64_X86
+    // 参考 Wojciech Muła, "Base64 encoding and decoding with SIMD instructions"
+
+    /// @brief 每个32位组中的3字节 -> 4个6位索引
+    __attribute__((target("ssse3"))) inline __m128i enc_reshuffle(__m128i in) {
+        in = _mm_shuffle_epi8(in, _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1));
+        const __m128i t0 = _mm_and_si128(in, _mm_set1_epi32(0x0fc0fc00));
+        const __m128i t1 = _mm_mulhi_epu16(t0, _mm_set1_epi32(0x04000040));
+        const __m128i t2 = _mm_and_si128(in, _mm_set1_epi32(0x003f03f0));
+        const __m128i t3 = _mm_mullo_epi16(t2, _mm_set1_epi32(0x01000010));
+        return _mm_or_si128(t1, t3);
+    }
+    /// @brief 6位索引 -> ASCII
+    __attribute__((target("ssse3"))) inline __m128i enc_translate(__m128i in) {
+        __m128i result = _mm_subs_epu8(in, _mm_set1_epi8(51));
+        const __m128i less = _mm_cmpgt_epi8(_mm_set1_epi8(26), in);
+        result = _mm_or_si128(result, _mm_and_si128(less, _mm_set1_epi8(13)));
+        const __m128i shift = _mm_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                            '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
+        return _mm_add_epi8(_mm_shuffle_epi8(shift, result), in);
+    }
+    __attribute__((target("ssse3"))) size_t encode_ssse3(const uint8_t *data, size_t dlen, char *out) {
+        size_t i = 0;
+        // 每次读取16字节, 使用其中12字节
+        for (; i + 16 <= dlen; i += 12, out += 16) {
+            const __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(out), enc_translate(enc_reshuffle(in)));
         }
+        return i;
     }
-    std::string b64encode(const uint8_t *data, uint32_t dlen) {
-        uint32_t olen = dlen / 3 * 4;
-        const uint32_t tail = dlen % 3;
-        olen += tail > 0 ? 4 : 0;
+    __attribute__((target("avx2"))) size_t encode_avx2(const uint8_t *data, size_t dlen, char *out) {
+        const __m256i shuffle = _mm256_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1,
+                                                10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1);
+        const __m256i shift = _mm256_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                               '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0,
+                                               'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                               '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
+        size_t i = 0;
+        // 两个128位通道各取12字节, 共读取 [i, i + 28)
+        for (; i + 28 <= dlen; i += 24, out += 32) {
+            const __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
+            const __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i + 12));
+            __m256i in = _mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1);
+            in = _mm256_shuffle_epi8(in, shuffle);
+            const __m256i t0 = _mm256_and_si256(in, _mm256_set1_epi32(0x0fc0fc00));
+            const __m256i t1 = _mm256_mulhi_epu16(t0, _mm256_set1_epi32(0x04000040));
+            const __m256i t2 = _mm256_and_si256(in, _mm256_set1_epi32(0x003f03f0));
+            const __m256i t3 = _mm256_mullo_epi16(t2, _mm256_set1_epi32(0x01000010));
+            const __m256i idx = _mm256_or_si256(t1, t3);
 
-        std::string enstr;
-        enstr.resize(olen);
-        auto *endata = enstr.data();
-        for (uint32_t i = 0; i + 3 <= dlen; i += 3) {
+            __m256i result = _mm256_subs_epu8(idx, _mm256_set1_epi8(51));
+            const __m256i less = _mm256_cmpgt_epi8(_mm256_set1_epi8(26), idx);
+            result = _mm256_or_si256(result, _mm256_and_si256(less, _mm256_set1_epi8(13)));
+            result = _mm256_add_epi8(_mm256_shuffle_epi8(shift, result), idx);
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(out), result);
+        }
+        return i + encode_ssse3(data + i, dlen - i, out);
+    }
+
+    /// @brief 校验并将ASCII转换为6位值, 含非法字符时返回 false
+    __attribute__((target("ssse3"))) inline bool dec_translate(__m128i in, __m128i &values) {
+        const __m128i lut_lo = _mm_setr_epi8(0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+                                             0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A);
+        const __m128i lut_hi = _mm_setr_epi8(0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08,
+                                             0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+        const __m128i lut_roll = _mm_setr_epi8(0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+        const __m128i hi_nibbles = _mm_and_si128(_mm_srli_epi32(in, 4), _mm_set1_epi8(0x0f));
+        const __m128i lo_nibbles = _mm_and_si128(in, _mm_set1_epi8(0x0f));
+        const __m128i lo = _mm_shuffle_epi8(lut_lo, lo_nibbles);
+        const __m128i hi = _mm_shuffle_epi8(lut_hi, hi_nibbles);
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_and_si128(lo, hi), _mm_setzero_si128())) != 0xFFFF) return false;
+        const __m128i eq_2f = _mm_cmpeq_epi8(in, _mm_set1_epi8(0x2F));
+        const __m128i roll = _mm_shuffle_epi8(lut_roll, _mm_add_epi8(eq_2f, hi_nibbles));
+        values = _mm_add_epi8(in, roll);
+        return true;
+    }
+    /// @brief 4个6位值 -> 3字节, 结果位于低12字节
+    __attribute__((target("ssse3"))) inline __m128i dec_pack(__m128i values) {
+        const __m128i merged = _mm_maddubs_epi16(values, _mm_set1_epi32(0x01400140));
+        const __m128i out = _mm_madd_epi16(merged, _mm_set1_epi32(0x00011000));
+        return _mm_shuffle_epi8(out, _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+    }
+    __attribute__((target("ssse3"))) size_t decode_ssse3(const uint8_t *data, size_t dlen, uint8_t *out) {
+        size_t i = 0;
+        // 每次写出16字节, 其中12字节有效; 至少留下8个字符, 保证不会写出输出缓冲区
+        for (; i + 24 <= dlen; i += 16, out += 12) {
+            __m128i values;
+            if (!dec_translate(_mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i)), values)) break;
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(out), dec_pack(values));
+        }
+        return i;
+    }
+    __attribute__((target("avx2"))) size_t decode_avx2(const uint8_t *data, size_t dlen, uint8_t *out) {
+        const __m256i lut_lo = _mm256_setr_epi8(0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+                                                0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A,
+                                                0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+                                                0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A);
+        const __m256i lut_hi = _mm256_setr_epi8(0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08,
+                                                0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+                                                0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08,
+                                                0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+        const __m256i lut_roll = _mm256_setr_epi8(0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0,
+                                                  0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+        const __m256i pack = _mm256_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+                                              2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+        size_t i = 0;
+        // 每次写出32字节, 其中24字节有效; 至少留下16个字符, 保证不会写出输出缓冲区
+        for (; i + 48 <= dlen; i += 32, out += 24) {
+            const __m256i in = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i));
+            const __m256i hi_nibbles = _mm256_and_si256(_mm256_srli_epi32(in, 4), _mm256_set1_epi8(0x0f));
+            const __m256i lo_nibbles = _mm256_and_si256(in, _mm256_set1_epi8(0x0f));
+            const __m256i lo = _mm256_shuffle_epi8(lut_lo, lo_nibbles);
+            const __m256i hi = _mm256_shuffle_epi8(lut_hi, hi_nibbles);
+            if (!_mm256_testz_si256(lo, hi)) break;
+            const __m256i eq_2f = _mm256_cmpeq_epi8(in, _mm256_set1_epi8(0x2F));
+            const __m256i roll = _mm256_shuffle_epi8(lut_roll, _mm256_add_epi8(eq_2f, hi_nibbles));
+            const __m256i values = _mm256_add_epi8(in, roll);
+            const __m256i merged = _mm256_maddubs_epi16(values, _mm256_set1_epi32(0x01400140));
+            __m256i result = _mm256_madd_epi16(merged, _mm256_set1_epi32(0x00011000));
+            result = _mm256_shuffle_epi8(result, pack);
+            result = _mm256_permutevar8x32_epi32(result, _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 7, 7));
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(out), result);
+        }
+        return i + decode_ssse3(data + i, dlen - i, out);
+    }
+#endif
+
+    /// @brief 按CPU特性选择内核, 只在首次调用时检测
+    EncodeKernel encode_kernel() {
+        static const EncodeKernel kernel = []() -> EncodeKernel {
+#ifdef BADGECPP_B64_X86
+            __builtin_cpu_init();
+            if (__builtin_cpu_supports("avx2")) return encode_avx2;
+            if (__builtin_cpu_supports("ssse3")) return encode_ssse3;
+#endif
+            return encode_none;
+        }();
+        return kernel;
+    }
+    DecodeKernel decode_kernel() {
+        static const DecodeKernel kernel = []() -> DecodeKernel {
+#ifdef BADGECPP_B64_X86
+            __builtin_cpu_init();
+            if (__builtin_cpu_supports("avx2")) return decode_avx2;
+            if (__builtin_cpu_supports("ssse3")) return decode_ssse3;
+#endif
+            return decode_none;
+        }();
+        return kernel;
+    }
+
+    /// @brief 校验 data[from, end) 是否都是合法的b64字符, '=' 只能出现在结尾
+    bool valid_from(std::string_view data, size_t from) {
+        const auto data_length = data.length();
+        for (size_t i = from; i < data_length; ++i) {
+            if (data[i] == '=') {
+                if (i != (data_length - 1) && data[i + 1] != '=') {
+                    return false;
+                }
+            } else {
+                if (const auto idx = static_cast<uint8_t>(data[i]); idx >= sizeof(reverse_map) || reverse_map[idx] == 255)
+                    return false;
+            }
+        }
+        return true;
+    }
+
+    /// @brief 标量编码, 处理全部输入 (含填充)
+    void encode_scalar(const uint8_t *data, size_t dlen, char *endata) {
+        const size_t tail = dlen % 3;
+        for (size_t i = 0; i + 3 <= dlen; i += 3) {
             *endata++ = alphabet_map[data[i] >> 2];
             *endata++ = alphabet_map[((data[i] << 4) & 0x30) | (data[i + 1] >> 4)];
             *endata++ = alphabet_map[((data[i + 1] << 2) & 0x3c) | (data[i + 2] >> 6)];
@@ -73,19 +221,49 @@ namespace badge::b64 {
             *endata++ = alphabet_map[(data[dlen - 1] << 2) & 0x3c];
             *endata = '=';
         }
+    }
+}// namespace
+namespace badge::b64 {
+
+    void b64encode(std::istream &in, std::ostream &out) {
+        // 块长度为3的倍数, 只有最后一块可能需要填充
+        constexpr size_t buffer_size = 3 * 1024;
+        uint8_t buffer[buffer_size];
+        char encoded[encoded_size(buffer_size)];
+
+        while (in) {
+            in.read(reinterpret_cast<char *>(buffer), buffer_size);
+            const auto bytes_read = static_cast<size_t>(in.gcount());
+            if (bytes_read == 0) break;
+            out.write(encoded, static_cast<std::streamsize>(b64encode(buffer, bytes_read, encoded)));
+        }
+    }
+    size_t b64encode(const uint8_t *data, size_t dlen, char *out) {
+        const size_t done = encode_kernel()(data, dlen, out);
+        encode_scalar(data + done, dlen - done, out + done / 3 * 4);
+        return encoded_size(dlen);
+    }
+    std::string b64encode(const uint8_t *data, uint32_t dlen) {
+        std::string enstr;
+        enstr.resize(encoded_size(dlen));
+        b64encode(data, dlen, enstr.data());
         return enstr;
     }
 
     std::vector<uint8_t> b64decode(const std::string &data) {
-        if (!isbase64(data)) return {};
+        if (data.length() % 4 > 0) return {};
 
         const auto edata = reinterpret_cast<const uint8_t *>(data.data());
         const uint32_t dlen = data.size();
 
-        uint8_t quad[4];
         std::vector<uint8_t> odata(dlen / 4 * 3);
-        uint8_t *ddata = odata.data();
-        for (uint32_t i = 0; i + 3 < dlen; i += 4) {
+        // 向量内核只接受合法字符, 因此只需校验其余部分
+        const size_t done = decode_kernel()(edata, dlen, odata.data());
+        if (!valid_from(data, done)) return {};
+
+        uint8_t quad[4];
+        uint8_t *ddata = odata.data() + done / 4 * 3;
+        for (uint32_t i = done; i + 3 < dlen; i += 4) {
             for (uint32_t j = 0; j < 4; j++) quad[j] = reverse_map[edata[i + j]];
             *ddata++ = (quad[0] << 2) | (quad[1] >> 4);
             if (quad[2] >= 64) break;
@@ -102,20 +280,8 @@ namespace badge::b64 {
     }
 
     bool isbase64(const std::string &data) {
-        const auto data_length = data.length();
-        if (data_length % 4 > 0) return false;
-
-        for (size_t i = 0; i < data_length; ++i) {
-            if (data.at(i) == '=') {
-                if (i != (data_length - 1) && data.at(i + 1) != '=') {
-                    return false;
-                }
-            } else {
-                if (const auto idx = static_cast<uint8_t>(data.at(i)); idx >= sizeof(reverse_map) || reverse_map[idx] == 255)
-                    return false;
-            }
-        }
-        return true;
+        if (data.length() % 4 > 0) return false;
+        return valid_from(data, 0);
     }
 
 }// namespace badge::b64
\ No newline at end of file
@@ -1,10 +1,54 @@
 #include "badgecpp/badge.hpp"
+#include "badgecpp/font.hpp"
 #include "badgecpp/render.hpp"
 namespace badge {
+    std::string BadgeView::makeBadge() const {
+        std::string out;
+        makeBadge(out);
+        return out;
+    }
+    void BadgeView::makeBadge(std::string &out) const {
+        Render::render(*this, out);
+    }
+    Xml BadgeView::makeBadgeXml() const {
+        return Render::renderXml(*this);
+    }
+    pmr::Xml BadgeView::makeBadgeXml(std::pmr::memory_resource *resource) const {
+        return Render::renderXml(*this, resource);
+    }
+
     std::string Badge::makeBadge() const {
-        return makeBadgeXml().render();
+        std::string out;
+        makeBadge(out);
+        return out;
+    }
+    void Badge::makeBadge(std::string &out) const {
+        Render::render(view(), out);
     }
     Xml Badge::makeBadgeXml() const {
-        return Render::create(*this)->render();
+        return Render::renderXml(view());
+    }
+    pmr::Xml Badge::makeBadgeXml(std::pmr::memory_resource *resource) const {
+        return Render::renderXml(view(), resource);
+    }
+    BadgeView Badge::view() const {
+        return {label_, label_color_, message_, message_color_, style_, logo_.get(), logo_color_, logo_width_, id_suffix_};
+    }
+    bool Badge::operator==(const Badge &other) const {
+        return label_ == other.label_ &&
+               label_color_ == other.label_color_ &&
+               message_ == other.message_ &&
+               message_color_ == other.message_color_ &&
+               style_ == other.style_ &&
+               logo_ == other.logo_ &&
+               logo_color_ == other.logo_color_ &&
+               logo_width_ == other.logo_width_ &&
+               id_suffix_ == other.id_suffix_;
+    }
+    void warmup() {
+        (void) Fonts::getFonts();
+        (void) BuiltinIcons::icons();
+        for (auto style: {FLAT, FLAT_SQUARE, PLASTIC, FOR_THE_BADGE, SOCIAL})
+            (void) Badge{"warmup", std::nullopt, "warmup", std::nullopt, style}.makeBadge();
     }
 }// namespace badge
\ No newline at end of file
@@ -0,0 +1,102 @@
+#include "badgecpp/batch.hpp"
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
+namespace badge {
+    /// @brief renderBatch 的实现, 可以访问 BatchOutput 的私有成员
+    struct BatchRenderer {
+        /// @brief 一个分块的渲染结果
+        struct Chunk {
+            std::string data;
+            std::vector<std::size_t> sizes;
+        };
+
+        /// @brief 顺序渲染时, 渲染这么多个徽章后估算总长度
+        static constexpr std::size_t ESTIMATE_SAMPLE = 64;
+
+        template<typename Item>
+        static void renderSequential(const Item *badges, std::size_t count, BatchOutput &output) {
+            output.offsets_.reserve(count + 1);
+            for (std::size_t i = 0; i < count; ++i) {
+                badges[i].makeBadge(output.data_);
+                output.offsets_.push_back(output.data_.size());
+                // 按已渲染部分的平均长度一次性预留, 避免大缓冲区反复扩容复制
+                if (i + 1 == ESTIMATE_SAMPLE && count > ESTIMATE_SAMPLE)
+                    output.data_.reserve(output.data_.size() / ESTIMATE_SAMPLE * count / 8 * 9);
+            }
+        }
+
+        template<typename Item>
+        static void renderParallel(const Item *badges, std::size_t count, std::size_t chunk_size, unsigned int threads, BatchOutput &output) {
+            const std::size_t chunk_count = (count + chunk_size - 1) / chunk_size;
+            std::vector<Chunk> chunks(chunk_count);
+            std::atomic<std::size_t> next{0};
+            std::atomic<bool> failed{false};
+            std::exception_ptr error;
+            std::mutex error_mutex;
+
+            const auto worker = [&]() {
+                try {
+                    for (std::size_t c; !failed.load(std::memory_order_relaxed) &&
+                                        (c = next.fetch_add(1, std::memory_order_relaxed)) < chunk_count;) {
+                        auto &chunk = chunks[c];
+                        const std::size_t begin = c * chunk_size, end = std::min(count, begin + chunk_size);
+                        chunk.sizes.reserve(end - begin);
+                        for (std::size_t i = begin; i < end; ++i) {
+                            const std::size_t before = chunk.data.size();
+                            badges[i].makeBadge(chunk.data);
+                            chunk.sizes.push_back(chunk.data.size() - before);
+                        }
+                    }
+                } catch (...) {
+                    std::lock_guard lock{error_mutex};
+                    if (!error) error = std::current_exception();
+                    failed.store(true, std::memory_order_relaxed);
+                }
+            };
+
+            std::vector<std::thread> pool;
+            pool.reserve(threads - 1);
+            try {
+                for (unsigned int t = 1; t < threads; ++t) pool.emplace_back(worker);
+            } catch (...) {
+                // 无法创建更多线程 (如 std::system_error): 不再创建, 剩余分块由已启动的线程与调用线程领取
+            }
+            worker();// 调用线程也参与渲染
+            for (auto &thread: pool) thread.join();
+            if (error) std::rethrow_exception(error);
+
+            // 按分块顺序拼接, 保证结果与顺序渲染一致
+            std::size_t total = 0;
+            for (const auto &chunk: chunks) total += chunk.data.size();
+            output.data_.reserve(total);
+            output.offsets_.reserve(count + 1);
+            for (auto &chunk: chunks) {
+                for (const auto size: chunk.sizes) output.offsets_.push_back(output.offsets_.back() + size);
+                output.data_ += chunk.data;
+                std::string{}.swap(chunk.data);// 尽早释放分块缓冲区
+            }
+        }
+
+        template<typename Item>
+        static BatchOutput render(const Item *badges, std::size_t count, const BatchOptions &options) {
+            BatchOutput output;
+            const std::size_t chunk_size = std::max<std::size_t>(options.chunk_size, 1);
+            unsigned int threads = options.threads != 0 ? options.threads : std::max(std::thread::hardware_concurrency(), 1u);
+            threads = static_cast<unsigned int>(std::min<std::size_t>(threads, (count + chunk_size - 1) / chunk_size));
+
+            if (threads <= 1) renderSequential(badges, count, output);
+            else renderParallel(badges, count, chunk_size, threads, output);
+            return output;
+        }
+    };
+
+    BatchOutput renderBatch(const Badge *badges, std::size_t count, const BatchOptions &options) {
+        return BatchRenderer::render(badges, count, options);
+    }
+    BatchOutput renderBatch(const BadgeView *badges, std::size_t count, const BatchOptions &options) {
+        return BatchRenderer::render(badges, count, options);
+    }
+}// namespace badge
\ No newline at end of file
@@ -0,0 +1,117 @@
+#include "badgecpp/cache.hpp"
+#include "badgecpp/color.hpp"
+#include <algorithm>
+#include <functional>
+#include <mutex>
+#include <string_view>
+namespace {
+    using namespace badge;
+
+    void hash_combine(std::size_t &seed, std::size_t value) {
+        seed ^= value + static_cast<std::size_t>(0x9e3779b97f4a7c15ULL) + (seed << 6) + (seed >> 2);
+    }
+    std::size_t hash_of(const std::optional<std::string> &str) {
+        return str ? std::hash<std::string_view>{}(*str) : 0x5bd1e995;
+    }
+    std::size_t hash_of(const std::optional<Color> &color) {
+        return color ? ColorHash{}(*color) : 0x27d4eb2f;
+    }
+}// namespace
+namespace badge {
+    std::size_t BadgeHash::operator()(const Badge &b) const {
+        std::size_t seed = static_cast<std::size_t>(b.style_);
+        hash_combine(seed, hash_of(b.label_));
+        hash_combine(seed, hash_of(b.label_color_));
+        hash_combine(seed, hash_of(b.message_));
+        hash_combine(seed, hash_of(b.message_color_));
+        hash_combine(seed, std::hash<const Icon *>{}(b.logo_.get()));
+        hash_combine(seed, hash_of(b.logo_color_));
+        hash_combine(seed, b.logo_width_ ? *b.logo_width_ : ~0u);
+        hash_combine(seed, hash_of(b.id_suffix_));
+        return seed;
+    }
+
+    BadgeCache::BadgeCache(std::size_t capacity, std::size_t shards) {
+        if (shards == 0) shards = 1;
+        shard_capacity_ = std::max<std::size_t>(1, (capacity + shards - 1) / shards);
+        shards_.reserve(shards);
+        for (std::size_t i = 0; i < shards; ++i) {
+            shards_.push_back(std::make_unique<Shard>());
+            shards_.back()->map.reserve(shard_capacity_);
+            shards_.back()->ring.reserve(shard_capacity_);
+        }
+    }
+    BadgeCache::Shard &BadgeCache::shard_of(std::size_t hash) const {
+        // 高位选分片, 低位留给分片内的哈希表
+        return *shards_[(hash >> 16) % shards_.size()];
+    }
+    std::shared_ptr<const std::string> BadgeCache::find(const Badge &badge) const {
+        auto &shard = shard_of(BadgeHash{}(badge));
+        std::shared_lock lock{shard.mutex};
+        auto it = shard.map.find(badge);
+        if (it == shard.map.end()) {
+            misses_.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        }
+        it->second.referenced.store(true, std::memory_order_relaxed);
+        hits_.fetch_add(1, std::memory_order_relaxed);
+        return it->second.svg;
+    }
+    std::shared_ptr<const std::string> BadgeCache::get(const Badge &badge) {
+        if (auto svg = find(badge)) return svg;
+
+        auto svg = std::make_shared<const std::string>(badge.makeBadge());
+
+        auto &shard = shard_of(BadgeHash{}(badge));
+        std::unique_lock lock{shard.mutex};
+        // 其他线程可能已经插入
+        if (auto it = shard.map.find(badge); it != shard.map.end()) return it->second.svg;
+        insert(shard, badge, svg);
+        return svg;
+    }
+    void BadgeCache::insert(Shard &shard, const Badge &badge, std::shared_ptr<const std::string> svg) {
+        std::size_t slot;
+        if (shard.ring.size() < shard_capacity_) {
+            slot = shard.ring.size();
+            shard.ring.push_back(nullptr);
+        } else {
+            // CLOCK: 跳过并清除最近被引用的条目, 淘汰第一个未被引用的
+            while (true) {
+                auto victim = shard.map.find(*shard.ring[shard.hand]);
+                if (!victim->second.referenced.exchange(false, std::memory_order_relaxed)) {
+                    shard.map.erase(victim);
+                    evictions_.fetch_add(1, std::memory_order_relaxed);
+                    break;
+                }
+                shard.hand = (shard.hand + 1) % shard_capacity_;
+            }
+            slot = shard.hand;
+            shard.hand = (shard.hand + 1) % shard_capacity_;
+        }
+        auto [it, _] = shard.map.emplace(std::piecewise_construct,
+                                         std::forward_as_tuple(badge),
+                                         std::forward_as_tuple(std::move(svg)));
+        shard.ring[slot] = &it->first;
+    }
+    void BadgeCache::clear() {
+        for (auto &shard: shards_) {
+            std::unique_lock lock{shard->mutex};
+            shard->map.clear();
+            shard->ring.clear();
+            shard->hand = 0;
+        }
+    }
+    BadgeCache::Stats BadgeCache::stats() const {
+        std::size_t size = 0;
+        for (const auto &shard: shards_) {
+            std::shared_lock lock{shard->mutex};
+            size += shard->map.size();
+        }
+        return {
+                hits_.load(std::memory_order_relaxed),
+                misses_.load(std::memory_order_relaxed),
+                evictions_.load(std::memory_order_relaxed),
+                size,
+        };
+    }
+}// namespace badge
\ No newline at end of file
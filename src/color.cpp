@@ -1,80 +1,99 @@
 #include "badgecpp/color.hpp"
+#include <algorithm>
+#include <charconv>
 #include <cmath>
 #include <cstddef>
 #include <cstdint>
+#include <cstdio>
 #include <optional>
 #include <stdexcept>
 #include <string>
 #include <string_view>
-#include <unordered_map>
+#include <tuple>
 
 namespace {
-    bool startsWith(const std::string_view &str, const std::string_view &prefix) {
-        return str.size() > prefix.size() && str.compare(0, prefix.size(), prefix) == 0;
+    constexpr bool isSpace(char c) noexcept {
+        return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f' || c == '\v';
     }
-    std::string_view trim(const std::string_view &str) {
-        auto first = str.find_first_not_of(" \t\n\r\f\v");
-        if (first == std::string_view::npos)
-            return "";
-        auto last = str.find_last_not_of(" \t\n\r\f\v");
-        return str.substr(first, last - first + 1);
+    std::string_view trim(std::string_view str) noexcept {
+        while (!str.empty() && isSpace(str.front())) str.remove_prefix(1);
+        while (!str.empty() && isSpace(str.back())) str.remove_suffix(1);
+        return str;
     }
+    /// @return 十六进制数字的值, 非十六进制数字返回 -1
+    constexpr int hexDigit(char c) noexcept {
+        if (c >= '0' && c <= '9') return c - '0';
+        if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+        return -1;
+    }
+
+    /// @brief 函数形式颜色 (rgb(...), hsl(...) 等) 参数列表的单遍解析器
+    /// @details 所有方法失败时返回 false 而不抛出异常, 也不分配内存; 数字由 std::from_chars 解析.
+    ///          每个参数前后允许空白, 参数之间以 ',' 分隔, 最后以 ')' 结尾且其后不能有其他字符.
+    struct ArgsParser {
+        const char *pos;
+        const char *end;
 
+        /// @param args 函数名和 '(' 之后的部分
+        explicit ArgsParser(std::string_view args) noexcept : pos(args.data()), end(args.data() + args.size()) {}
 
-    /// @brief 解析0-255的整数
-    /// @return 0-255
-    uint8_t fromI(const std::string_view &num, int base = 10) {
-        int value = 0;
-        size_t pos = 0;
-        try {
-            value = std::stoi(std::string(num), &pos, base);
-        } catch (...) { throw std::runtime_error(""); }
-        if (pos != num.size() || value < 0 || value > 255) throw std::runtime_error("");
-        return static_cast<uint8_t>(value);
-    }
-    /// @brief 解析0-1的浮点数
-    /// @return 0-255
-    uint8_t fromD(const std::string_view &num) {
-        float value = 0.0f;
-        size_t pos = 0;
-        try {
-            value = std::stof(std::string(num), &pos);
-        } catch (...) { throw std::runtime_error(""); }
-        if (pos != num.size() || value < 0.0f || value > 1.0f) throw std::runtime_error("");
-        return static_cast<uint8_t>(std::round(value * 255));
-    }
-    /// @brief 解析0-360的角度
-    /// @return 0-360
-    int fromH(const std::string_view &num) {
-        int value = 0;
-        size_t pos = 0;
-        try {
-            value = std::stoi(std::string(num), &pos);
-        } catch (...) { throw std::runtime_error(""); }
-        if (pos != num.size() || value < 0 || value > 360) throw std::runtime_error("");
-        return value;
-    }
-    /// @brief 解析0%-100%百分比
-    /// @return 0-1
-    float fromP(const std::string_view &num) {
-        if (num.back() != '%') throw std::runtime_error("");
-        float value = 0.0f;
-        size_t pos = 0;
-        try {
-            value = std::stof(std::string(num.substr(0, num.size() - 1)), &pos);
-        } catch (...) { throw std::runtime_error(""); }
-        if (pos != num.size() - 1 || value < 0.0f || value > 100.0f) throw std::runtime_error("");
-        return value / 100.0f;
-    }
-    /// @brief 辅助函数: 将start设为end下一个字符, 然后从str的start位置开始, 找到need下一次出现的位置, 设置end位置
-    /// @return true表示解析失败, false表示解析成功
-    constexpr auto next = [](const std::string_view &str, char need, size_t &start, size_t &end) {
-        start = end + 1;
-        end = str.find(need, start);
-        return end == std::string_view::npos;
+        void skipSpace() noexcept {
+            while (pos != end && isSpace(*pos)) ++pos;
+        }
+        /// @brief 跳过空白后读取分隔符 sep; sep 为 ')' 时还要求已到达结尾
+        bool separator(char sep) noexcept {
+            skipSpace();
+            if (pos == end || *pos != sep) return false;
+            ++pos;
+            return sep != ')' || pos == end;
+        }
+        /// @brief 读取一个数字, 允许前导 '+' (与 std::stoi / std::stof 相同)
+        template<typename T>
+        bool number(T &value) noexcept {
+            skipSpace();
+            if (pos != end && *pos == '+' && end - pos > 1 && pos[1] != '-' && pos[1] != '+') ++pos;
+            const auto [ptr, ec] = std::from_chars(pos, end, value);
+            if (ec != std::errc{}) return false;
+            pos = ptr;
+            return true;
+        }
+
+        /// @brief 0-255的整数
+        bool byte(uint8_t &out) noexcept {
+            int value;
+            if (!number(value) || value < 0 || value > 255) return false;
+            out = static_cast<uint8_t>(value);
+            return true;
+        }
+        /// @brief 0-1的浮点数, 输出 0-255
+        bool alpha(uint8_t &out) noexcept {
+            float value;
+            if (!number(value) || !(value >= 0.0f && value <= 1.0f)) return false;
+            out = static_cast<uint8_t>(std::round(value * 255));
+            return true;
+        }
+        /// @brief 0-360的角度
+        bool hue(int &out) noexcept {
+            return number(out) && out >= 0 && out <= 360;
+        }
+        /// @brief 0%-100%百分比, 输出 0-1
+        bool percent(float &out) noexcept {
+            if (!number(out) || !(out >= 0.0f && out <= 100.0f)) return false;
+            if (pos == end || *pos != '%') return false;
+            ++pos;
+            out /= 100.0f;
+            return true;
+        }
     };
 
-    std::array<uint8_t, 4> hsl2rgb(int H, float S, float L, uint8_t A) {
+    /// @brief 若 str 以 name 开头, 返回之后的参数列表
+    std::optional<std::string_view> functionArgs(std::string_view str, std::string_view name) noexcept {
+        if (str.size() <= name.size() || str.compare(0, name.size(), name) != 0) return std::nullopt;
+        return str.substr(name.size());
+    }
+
+    std::array<uint8_t, 4> hsl2rgb(int H, float S, float L, uint8_t A) noexcept {
         float C = (1 - std::fabs(2 * L - 1)) * S;            // Chroma
         float X = C * (1 - std::fabs(fmod(H / 60.0, 2) - 1));// Intermediate value
         float m = L - C / 2;                                 // Match lightness
@@ -87,20 +106,324 @@ namespace {
             case 2: rp = 0; gp = C; bp = X; break;
             case 3: rp = 0; gp = X; bp = C; break;
             case 4: rp = X; gp = 0; bp = C; break;
+            default:// H 已由解析器限制在 0-360
             case 5: rp = C; gp = 0; bp = X; break;
-            // clang-format on
-            default:
-                throw std::runtime_error("");
+                // clang-format on
         }
 
         return {
                 uint8_t((rp + m) * 255),
                 uint8_t((gp + m) * 255),
                 uint8_t((bp + m) * 255),
-                255,
+                A,
         };
     }
 
+
+    /// @brief CSS 命名颜色, 按名字排序; 同一颜色有多个名字时, 序列化使用最短的 (等长取靠前的)
+    struct NamedColor {
+        std::string_view name;
+        std::array<uint8_t, 4> value;
+    };
+    constexpr NamedColor NAMED_COLORS[] = {
+            {"aliceblue", {240, 248, 255, 255}},
+            {"antiquewhite", {250, 235, 215, 255}},
+            {"aqua", {0, 255, 255, 255}},
+            {"aquamarine", {127, 255, 212, 255}},
+            {"azure", {240, 255, 255, 255}},
+            {"beige", {245, 245, 220, 255}},
+            {"bisque", {255, 228, 196, 255}},
+            {"black", {0, 0, 0, 255}},
+            {"blanchedalmond", {255, 235, 205, 255}},
+            {"blue", {0, 0, 255, 255}},
+            {"blueviolet", {138, 43, 226, 255}},
+            {"brown", {165, 42, 42, 255}},
+            {"burlywood", {222, 184, 135, 255}},
+            {"cadetblue", {95, 158, 160, 255}},
+            {"chartreuse", {127, 255, 0, 255}},
+            {"chocolate", {210, 105, 30, 255}},
+            {"coral", {255, 127, 80, 255}},
+            {"cornflowerblue", {100, 149, 237, 255}},
+            {"cornsilk", {255, 248, 220, 255}},
+            {"crimson", {220, 20, 60, 255}},
+            {"cyan", {0, 255, 255, 255}},
+            {"darkblue", {0, 0, 139, 255}},
+            {"darkcyan", {0, 139, 139, 255}},
+            {"darkgoldenrod", {184, 134, 11, 255}},
+            {"darkgray", {169, 169, 169, 255}},
+            {"darkgreen", {0, 100, 0, 255}},
+            {"darkgrey", {169, 169, 169, 255}},
+            {"darkkhaki", {189, 183, 107, 255}},
+            {"darkmagenta", {139, 0, 139, 255}},
+            {"darkolivegreen", {85, 107, 47, 255}},
+            {"darkorange", {255, 140, 0, 255}},
+            {"darkorchid", {153, 50, 204, 255}},
+            {"darkred", {139, 0, 0, 255}},
+            {"darksalmon", {233, 150, 122, 255}},
+            {"darkseagreen", {143, 188, 143, 255}},
+            {"darkslateblue", {72, 61, 139, 255}},
+            {"darkslategray", {47, 79, 79, 255}},
+            {"darkslategrey", {47, 79, 79, 255}},
+            {"darkturquoise", {0, 206, 209, 255}},
+            {"darkviolet", {148, 0, 211, 255}},
+            {"deeppink", {255, 20, 147, 255}},
+            {"deepskyblue", {0, 191, 255, 255}},
+            {"dimgray", {105, 105, 105, 255}},
+            {"dimgrey", {105, 105, 105, 255}},
+            {"dodgerblue", {30, 144, 255, 255}},
+            {"firebrick", {178, 34, 34, 255}},
+            {"floralwhite", {255, 250, 240, 255}},
+            {"forestgreen", {34, 139, 34, 255}},
+            {"fuchsia", {255, 0, 255, 255}},
+            {"gainsboro", {220, 220, 220, 255}},
+            {"ghostwhite", {248, 248, 255, 255}},
+            {"gold", {255, 215, 0, 255}},
+            {"goldenrod", {218, 165, 32, 255}},
+            {"gray", {128, 128, 128, 255}},
+            {"green", {0, 128, 0, 255}},
+            {"greenyellow", {173, 255, 47, 255}},
+            {"grey", {128, 128, 128, 255}},
+            {"honeydew", {240, 255, 240, 255}},
+            {"hotpink", {255, 105, 180, 255}},
+            {"indianred", {205, 92, 92, 255}},
+            {"indigo", {75, 0, 130, 255}},
+            {"ivory", {255, 255, 240, 255}},
+            {"khaki", {240, 230, 140, 255}},
+            {"lavender", {230, 230, 250, 255}},
+            {"lavenderblush", {255, 240, 245, 255}},
+            {"lawngreen", {124, 252, 0, 255}},
+            {"lemonchiffon", {255, 250, 205, 255}},
+            {"lightblue", {173, 216, 230, 255}},
+            {"lightcoral", {240, 128, 128, 255}},
+            {"lightcyan", {224, 255, 255, 255}},
+            {"lightgoldenrodyellow", {250, 250, 210, 255}},
+            {"lightgray", {211, 211, 211, 255}},
+            {"lightgreen", {144, 238, 144, 255}},
+            {"lightgrey", {211, 211, 211, 255}},
+            {"lightpink", {255, 182, 193, 255}},
+            {"lightsalmon", {255, 160, 122, 255}},
+            {"lightseagreen", {32, 178, 170, 255}},
+            {"lightskyblue", {135, 206, 250, 255}},
+            {"lightslategray", {119, 136, 153, 255}},
+            {"lightslategrey", {119, 136, 153, 255}},
+            {"lightsteelblue", {176, 196, 222, 255}},
+            {"lightyellow", {255, 255, 224, 255}},
+            {"lime", {0, 255, 0, 255}},
+            {"limegreen", {50, 205, 50, 255}},
+            {"linen", {250, 240, 230, 255}},
+            {"magenta", {255, 0, 255, 255}},
+            {"maroon", {128, 0, 0, 255}},
+            {"mediumaquamarine", {102, 205, 170, 255}},
+            {"mediumblue", {0, 0, 205, 255}},
+            {"mediumorchid", {186, 85, 211, 255}},
+            {"mediumpurple", {147, 112, 219, 255}},
+            {"mediumseagreen", {60, 179, 113, 255}},
+            {"mediumslateblue", {123, 104, 238, 255}},
+            {"mediumspringgreen", {0, 250, 154, 255}},
+            {"mediumturquoise", {72, 209, 204, 255}},
+            {"mediumvioletred", {199, 21, 133, 255}},
+            {"midnightblue", {25, 25, 112, 255}},
+            {"mintcream", {245, 255, 250, 255}},
+            {"mistyrose", {255, 228, 225, 255}},
+            {"moccasin", {255, 228, 181, 255}},
+            {"navajowhite", {255, 222, 173, 255}},
+            {"navy", {0, 0, 128, 255}},
+            {"oldlace", {253, 245, 230, 255}},
+            {"olive", {128, 128, 0, 255}},
+            {"olivedrab", {107, 142, 35, 255}},
+            {"orange", {255, 165, 0, 255}},
+            {"orangered", {255, 69, 0, 255}},
+            {"orchid", {218, 112, 214, 255}},
+            {"palegoldenrod", {238, 232, 170, 255}},
+            {"palegreen", {152, 251, 152, 255}},
+            {"paleturquoise", {175, 238, 238, 255}},
+            {"palevioletred", {219, 112, 147, 255}},
+            {"papayawhip", {255, 239, 213, 255}},
+            {"peachpuff", {255, 218, 185, 255}},
+            {"peru", {205, 133, 63, 255}},
+            {"pink", {255, 192, 203, 255}},
+            {"plum", {221, 160, 221, 255}},
+            {"powderblue", {176, 224, 230, 255}},
+            {"purple", {128, 0, 128, 255}},
+            {"rebeccapurple", {102, 51, 153, 255}},
+            {"red", {255, 0, 0, 255}},
+            {"rosybrown", {188, 143, 143, 255}},
+            {"royalblue", {65, 105, 225, 255}},
+            {"saddlebrown", {139, 69, 19, 255}},
+            {"salmon", {250, 128, 114, 255}},
+            {"sandybrown", {244, 164, 96, 255}},
+            {"seagreen", {46, 139, 87, 255}},
+            {"seashell", {255, 245, 238, 255}},
+            {"sienna", {160, 82, 45, 255}},
+            {"silver", {192, 192, 192, 255}},
+            {"skyblue", {135, 206, 235, 255}},
+            {"slateblue", {106, 90, 205, 255}},
+            {"slategray", {112, 128, 144, 255}},
+            {"slategrey", {112, 128, 144, 255}},
+            {"snow", {255, 250, 250, 255}},
+            {"springgreen", {0, 255, 127, 255}},
+            {"steelblue", {70, 130, 180, 255}},
+            {"tan", {210, 180, 140, 255}},
+            {"teal", {0, 128, 128, 255}},
+            {"thistle", {216, 191, 216, 255}},
+            {"tomato", {255, 99, 71, 255}},
+            {"transparent", {0, 0, 0, 0}},
+            {"turquoise", {64, 224, 208, 255}},
+            {"violet", {238, 130, 238, 255}},
+            {"wheat", {245, 222, 179, 255}},
+            {"white", {255, 255, 255, 255}},
+            {"whitesmoke", {245, 245, 245, 255}},
+            {"yellow", {255, 255, 0, 255}},
+            {"yellowgreen", {154, 205, 50, 255}},
+    };
+    constexpr std::string_view CURRENT_COLOR = "currentColor";
+
+    constexpr uint32_t fmix32(uint32_t h) noexcept {
+        h ^= h >> 16;
+        h *= 0x85ebca6bu;
+        h ^= h >> 13;
+        h *= 0xc2b2ae35u;
+        h ^= h >> 16;
+        return h;
+    }
+    /// @brief 小端读取 4 字节, 编译器会合并为一次加载
+    constexpr uint32_t load4(const char *p) noexcept {
+        return uint32_t{static_cast<uint8_t>(p[0])} | uint32_t{static_cast<uint8_t>(p[1])} << 8 |
+               uint32_t{static_cast<uint8_t>(p[2])} << 16 | uint32_t{static_cast<uint8_t>(p[3])} << 24;
+    }
+    /// @brief 只取长度与首尾各4字节, 不逐字节循环; 所有颜色名的哈希互不相同由 PerfectHash::build 在编译期保证
+    constexpr uint32_t hashName(std::string_view name) noexcept {
+        if (name.size() < 4) {
+            uint32_t h = static_cast<uint32_t>(name.size());
+            for (const char c: name) h = h << 8 | static_cast<uint8_t>(c);
+            return fmix32(h);
+        }
+        const uint32_t head = load4(name.data()), tail = load4(name.data() + name.size() - 4);
+        return fmix32(head ^ (tail << 13 | tail >> 19) ^ static_cast<uint32_t>(name.size()) * 0x9e3779b9u);
+    }
+    /// @brief std::array 的比较在 C++17 中不是 constexpr, 打包为整数后比较
+    constexpr uint32_t packValue(const std::array<uint8_t, 4> &v) noexcept {
+        return uint32_t{v[0]} | uint32_t{v[1]} << 8 | uint32_t{v[2]} << 16 | uint32_t{v[3]} << 24;
+    }
+    constexpr uint32_t hashValue(const std::array<uint8_t, 4> &v) noexcept {
+        return fmix32(packValue(v));
+    }
+
+    /// @brief 编译期构建的最小完美哈希 (hash-and-displace), 值为 NAMED_COLORS 的下标+1, 0表示空
+    /// @details 键的哈希 h 先落到桶 h % BUCKETS, 每个桶有一个位移 d, 槽位为 fmix32(h ^ d * 0x9e3779b9) & (SLOTS - 1).
+    ///          查找只需一次哈希和一次比较, 不分配内存, 也没有动态初始化.
+    struct PerfectHash {
+        static constexpr size_t BUCKETS = 64;
+        static constexpr size_t SLOTS = 256;
+        static constexpr size_t MAX_BUCKET_SIZE = 16;
+        static_assert(std::size(NAMED_COLORS) < 256, "index+1 must fit in uint8_t");
+
+        std::array<uint16_t, BUCKETS> displacement{};
+        std::array<uint8_t, SLOTS> slots{};
+
+        static constexpr size_t slotOf(uint32_t h, uint32_t d) noexcept {
+            return fmix32(h ^ d * 0x9e3779b9u) & (SLOTS - 1);
+        }
+        /// @return NAMED_COLORS 的下标+1, 0 表示一定不存在; 调用方需再比较键
+        [[nodiscard]] constexpr uint8_t find(uint32_t h) const noexcept {
+            return slots[slotOf(h, displacement[h % BUCKETS])];
+        }
+
+        /// @param hashes 各键的哈希
+        /// @param indexes 各键对应的 NAMED_COLORS 下标
+        template<size_t N>
+        static constexpr PerfectHash build(const std::array<uint32_t, N> &hashes, const std::array<uint8_t, N> &indexes, size_t count) {
+            PerfectHash table{};
+            std::array<size_t, BUCKETS> sizes{}, order{};
+            for (size_t i = 0; i < count; ++i) {
+                for (size_t k = 0; k < i; ++k)
+                    if (hashes[k] == hashes[i]) throw "duplicate hash";// 哈希相同的键无法区分
+                ++sizes[hashes[i] % BUCKETS];
+            }
+            // 大桶先放, 此时空槽多, 容易找到位移
+            for (size_t b = 0; b < BUCKETS; ++b) {
+                size_t j = b;
+                for (; j > 0 && sizes[order[j - 1]] < sizes[b]; --j) order[j] = order[j - 1];
+                order[j] = b;
+            }
+            for (const auto b: order) {
+                if (sizes[b] == 0) break;
+                if (sizes[b] > MAX_BUCKET_SIZE) throw "bucket too large";
+                for (uint32_t d = 0;; ++d) {
+                    if (d > 0xFFFF) throw "no displacement found";
+                    std::array<size_t, MAX_BUCKET_SIZE> taken{};
+                    size_t n = 0;
+                    bool ok = true;
+                    for (size_t i = 0; ok && i < count; ++i) {
+                        if (hashes[i] % BUCKETS != b) continue;
+                        const auto slot = slotOf(hashes[i], d);
+                        ok = table.slots[slot] == 0;
+                        for (size_t k = 0; ok && k < n; ++k) ok = taken[k] != slot;
+                        taken[n++] = slot;
+                    }
+                    if (!ok) continue;
+                    n = 0;
+                    for (size_t i = 0; i < count; ++i)
+                        if (hashes[i] % BUCKETS == b) table.slots[taken[n++]] = static_cast<uint8_t>(indexes[i] + 1);
+                    table.displacement[b] = static_cast<uint16_t>(d);
+                    break;
+                }
+            }
+            return table;
+        }
+    };
+
+    /// @brief 名字 -> 颜色
+    constexpr PerfectHash NAME_TABLE = [] {
+        constexpr size_t N = std::size(NAMED_COLORS);
+        std::array<uint32_t, N> hashes{};
+        std::array<uint8_t, N> indexes{};
+        for (size_t i = 0; i < N; ++i) {
+            hashes[i] = hashName(NAMED_COLORS[i].name);
+            indexes[i] = static_cast<uint8_t>(i);
+        }
+        return PerfectHash::build(hashes, indexes, N);
+    }();
+    /// @brief 颜色 -> 最短的名字
+    constexpr PerfectHash VALUE_TABLE = [] {
+        constexpr size_t N = std::size(NAMED_COLORS);
+        std::array<uint32_t, N> hashes{};
+        std::array<uint8_t, N> indexes{};
+        size_t count = 0;
+        for (size_t i = 0; i < N; ++i) {
+            size_t k = 0;
+            while (k < count && packValue(NAMED_COLORS[indexes[k]].value) != packValue(NAMED_COLORS[i].value)) ++k;
+            if (k == count) {
+                hashes[count] = hashValue(NAMED_COLORS[i].value);
+                indexes[count++] = static_cast<uint8_t>(i);
+            } else if (NAMED_COLORS[i].name.size() < NAMED_COLORS[indexes[k]].name.size()) {
+                indexes[k] = static_cast<uint8_t>(i);
+            }
+        }
+        return PerfectHash::build(hashes, indexes, count);
+    }();
+
+    constexpr const NamedColor *findNamedColor(std::string_view name) noexcept {
+        const auto index = NAME_TABLE.find(hashName(name));
+        return index && NAMED_COLORS[index - 1].name == name ? &NAMED_COLORS[index - 1] : nullptr;
+    }
+    constexpr const NamedColor *findNamedColor(const std::array<uint8_t, 4> &value) noexcept {
+        const auto index = VALUE_TABLE.find(hashValue(value));
+        return index && packValue(NAMED_COLORS[index - 1].value) == packValue(value) ? &NAMED_COLORS[index - 1] : nullptr;
+    }
+    constexpr bool allNamesFound() noexcept {
+        for (const auto &color: NAMED_COLORS)
+            if (findNamedColor(color.name) != &color || !findNamedColor(color.value)) return false;
+        return true;
+    }
+    static_assert(allNamesFound(), "named color perfect hash is broken");
+    static_assert(findNamedColor({128, 128, 128, 255})->name == "gray");
+    static_assert(!findNamedColor("grey ") && !findNamedColor(std::array<uint8_t, 4>{1, 2, 3, 255}));
+
+    /// @brief CSS currentColor 关键字 (接受 "currentColor" 和 "currentcolor")
+    bool isCurrentColor(std::string_view str) noexcept {
+        return str == CURRENT_COLOR || str == "currentcolor";
+    }
 }// namespace
 namespace badge {
     std::size_t ColorHash::operator()(const badge::Color &c) const {
@@ -109,106 +432,110 @@ namespace badge {
     Color::Color(std::string_view input, bool fail_silent) {
         decltype(value) tmp = value;
         if (parseString(input, tmp)) value = tmp;
+        else if (isCurrentColor(trim(input))) current_color = true;
         else if (!fail_silent)
             throw std::invalid_argument("[badgecpp::Color] Invalid color string: " + std::string(input));
     }
 
 
-    bool Color::parseString(std::string_view input, std::array<uint8_t, 4> &tmp) {
-        auto str = trim(input);
+    bool Color::parseString(std::string_view input, std::array<uint8_t, 4> &tmp) noexcept {
+        const auto str = trim(input);
         if (str.empty()) return false;
-        if (parseHex(str, tmp)) return true;
-        if (str.back() == ')') {
-            if (parseRGB(str, tmp)) return true;
-            if (parseRGBA(str, tmp)) return true;
-            if (parseHSL(str, tmp)) return true;
-            if (parseHSLA(str, tmp)) return true;
+        // 按首字符分派, 每个字符串只走一种语法
+        switch (str.front()) {
+            case '#':
+                return parseHex(str, tmp);
+            case 'r':
+                if (str.back() == ')' && str.compare(0, 3, "rgb") == 0) return parseRGB(str, tmp) || parseRGBA(str, tmp);
+                break;
+            case 'h':
+                if (str.back() == ')' && str.compare(0, 3, "hsl") == 0) return parseHSL(str, tmp) || parseHSLA(str, tmp);
+                break;
+            default:
+                break;
         }
-        if (parseName(str, tmp)) return true;
-        return false;
+        return parseName(str, tmp);
     }
-    bool Color::parseHex(std::string_view str, std::array<uint8_t, 4> &v) {
-        if (str[0] != '#') return false;
+    bool Color::parseHex(std::string_view str, std::array<uint8_t, 4> &v) noexcept {
+        if (str.empty() || str[0] != '#') return false;
         if (str.size() == 7) {
-            try {
-                for (size_t i = 0; i < 3; ++i) v[i] = fromI(str.substr(i * 2 + 1, 2), 16);
-
-            } catch (...) { return false; }
+            int digits[6];
+            for (size_t i = 0; i < 6; ++i)
+                if ((digits[i] = hexDigit(str[i + 1])) < 0) return false;
+            for (size_t i = 0; i < 3; ++i) v[i] = static_cast<uint8_t>(digits[i * 2] << 4 | digits[i * 2 + 1]);
             return true;
         }
         if (str.size() == 4) {
-            try {
-                for (size_t i = 0; i < 3; ++i) v[i] = fromI(str.substr(i + 1, 1), 16) * 17;
-            } catch (...) { return false; }
+            int digits[3];
+            for (size_t i = 0; i < 3; ++i)
+                if ((digits[i] = hexDigit(str[i + 1])) < 0) return false;
+            for (size_t i = 0; i < 3; ++i) v[i] = static_cast<uint8_t>(digits[i] * 17);
             return true;
         }
         return false;
     }
-    bool Color::parseRGB(std::string_view str, std::array<uint8_t, 4> &v) {
-        if (!startsWith(str, "rgb(") || str.back() != ')') return false;
-        size_t start, end = 3;
-        try {
-            for (int i = 0; i < 3; i++) {
-                if (next(str, i == 2 ? ')' : ',', start, end)) return false;
-                v[i] = fromI(trim(str.substr(start, end - start)));
-            }
-        } catch (...) { return false; }
+    bool Color::parseRGB(std::string_view str, std::array<uint8_t, 4> &v) noexcept {
+        const auto args = functionArgs(str, "rgb(");
+        if (!args) return false;
+        ArgsParser p{*args};
+        std::array<uint8_t, 3> rgb;
+        if (!(p.byte(rgb[0]) && p.separator(',') &&
+              p.byte(rgb[1]) && p.separator(',') &&
+              p.byte(rgb[2]) && p.separator(')'))) return false;
+        std::copy(rgb.begin(), rgb.end(), v.begin());
         return true;
     }
-    bool Color::parseRGBA(std::string_view str, std::array<uint8_t, 4> &v) {
-        if (!startsWith(str, "rgba(") || str.back() != ')') return false;
-        size_t start, end = 4;
-        try {
-            for (int i = 0; i < 3; i++) {
-                if (next(str, ',', start, end)) return false;
-                v[i] = fromI(trim(str.substr(start, end - start)));
-            }
-            if (next(str, ')', start, end)) return false;
-            v[3] = fromD(trim(str.substr(start, end - start)));
-        } catch (...) { return false; }
+    bool Color::parseRGBA(std::string_view str, std::array<uint8_t, 4> &v) noexcept {
+        const auto args = functionArgs(str, "rgba(");
+        if (!args) return false;
+        ArgsParser p{*args};
+        std::array<uint8_t, 4> rgba;
+        if (!(p.byte(rgba[0]) && p.separator(',') &&
+              p.byte(rgba[1]) && p.separator(',') &&
+              p.byte(rgba[2]) && p.separator(',') &&
+              p.alpha(rgba[3]) && p.separator(')'))) return false;
+        v = rgba;
         return true;
     }
-    bool Color::parseHSL(std::string_view str, std::array<uint8_t, 4> &v) {
-        if (!startsWith(str, "hsl(") || str.back() != ')') return false;
-        size_t start, end = 3;
-        try {
-            if (next(str, ',', start, end)) return false;
-            const auto H = fromH(trim(str.substr(start, end - start)));
-            if (next(str, ',', start, end)) return false;
-            const auto S = fromP(trim(str.substr(start, end - start)));
-            if (next(str, ')', start, end)) return false;
-            const auto L = fromP(trim(str.substr(start, end - start)));
-            v = hsl2rgb(H, S, L, 255);
-        } catch (...) { return false; }
+    bool Color::parseHSL(std::string_view str, std::array<uint8_t, 4> &v) noexcept {
+        const auto args = functionArgs(str, "hsl(");
+        if (!args) return false;
+        ArgsParser p{*args};
+        int H;
+        float S, L;
+        if (!(p.hue(H) && p.separator(',') &&
+              p.percent(S) && p.separator(',') &&
+              p.percent(L) && p.separator(')'))) return false;
+        v = hsl2rgb(H, S, L, 255);
         return true;
     }
-    bool Color::parseHSLA(std::string_view str, std::array<uint8_t, 4> &v) {
-        if (!startsWith(str, "hsla(") || str.back() != ')') return false;
-        size_t start, end = 4;
-        try {
-            if (next(str, ',', start, end)) return false;
-            const auto H = fromH(trim(str.substr(start, end - start)));
-            if (next(str, ',', start, end)) return false;
-            const auto S = fromP(trim(str.substr(start, end - start)));
-            if (next(str, ',', start, end)) return false;
-            const auto L = fromP(trim(str.substr(start, end - start)));
-            if (next(str, ')', start, end)) return false;
-            const auto A = fromD(trim(str.substr(start, end - start)));
-            v = hsl2rgb(H, S, L, A);
-        } catch (...) { return false; }
+    bool Color::parseHSLA(std::string_view str, std::array<uint8_t, 4> &v) noexcept {
+        const auto args = functionArgs(str, "hsla(");
+        if (!args) return false;
+        ArgsParser p{*args};
+        int H;
+        float S, L;
+        uint8_t A;
+        if (!(p.hue(H) && p.separator(',') &&
+              p.percent(S) && p.separator(',') &&
+              p.percent(L) && p.separator(',') &&
+              p.alpha(A) && p.separator(')'))) return false;
+        v = hsl2rgb(H, S, L, A);
         return true;
     }
-    bool Color::parseName(std::string_view str, std::array<uint8_t, 4> &v) {
-        auto itr = named_colors.find(str);
-        if (itr == named_colors.end()) return false;
-        v = itr->second.value;
+    bool Color::parseName(std::string_view str, std::array<uint8_t, 4> &v) noexcept {
+        const auto *named = findNamedColor(str);
+        if (!named) return false;
+        v = named->value;
         return true;
     }
 
 
     std::optional<Color> Color::parseString(std::string_view str) {
         Color tmp;
-        return parseString(str, tmp.value) ? std::make_optional(std::move(tmp)) : std::nullopt;
+        if (isCurrentColor(trim(str))) tmp.current_color = true;
+        else if (!parseString(str, tmp.value)) return std::nullopt;
+        return tmp;
     }
     std::optional<Color> Color::parseHex(std::string_view str) {
         Color tmp;
@@ -232,22 +559,34 @@ namespace badge {
     }
     std::optional<Color> Color::parseName(std::string_view str) {
         Color tmp;
-        return parseName(str, tmp.value) ? std::make_optional(std::move(tmp)) : std::nullopt;
+        if (isCurrentColor(str)) tmp.current_color = true;
+        else if (!parseName(str, tmp.value)) return std::nullopt;
+        return tmp;
     }
 
 
     std::string Color::to_str() const {
+        char buf[MAX_STR_LENGTH];
+        return {buf, to_chars(buf)};
+    }
+    size_t Color::to_chars(char *out) const {
+        const auto put = [out](std::string_view str) {
+            str.copy(out, str.size());
+            return str.size();
+        };
+        if (current_color) return put(CURRENT_COLOR);
+        const auto *named = findNamedColor(value);// 颜色名称更短时使用名称
         if (a() == 255) {
-            auto name = named_colors_reverse.find(*this);// 颜色名称
             static constexpr const char *HEX = "0123456789ABCDEF";
             if ((r() >> 4 == (r() & 0xF)) &&
                 (g() >> 4 == (g() & 0xF)) &&
                 (b() >> 4 == (b() & 0xF))) {
-                if (name != named_colors_reverse.end() && name->second.length() < 4) return name->second;
-                return {'#', HEX[r() & 0xF], HEX[g() & 0xF], HEX[b() & 0xF]};
+                if (named && named->name.length() < 4) return put(named->name);
+                const char str[] = {'#', HEX[r() & 0xF], HEX[g() & 0xF], HEX[b() & 0xF]};
+                return put({str, sizeof(str)});
             } else {
-                if (name != named_colors_reverse.end() && name->second.length() < 7) return name->second;
-                return {
+                if (named && named->name.length() < 7) return put(named->name);
+                const char str[] = {
                         '#',
                         HEX[r() >> 4],
                         HEX[r() & 0xF],
@@ -256,28 +595,25 @@ namespace badge {
                         HEX[b() >> 4],
                         HEX[b() & 0xF],
                 };
+                return put({str, sizeof(str)});
             }
         } else {
-            std::string str = "rgba(";
-            str += std::to_string(r());
-            str += ',';
-            str += std::to_string(g());
-            str += ',';
-            str += std::to_string(b());
-            str += ',';
-            auto A = std::to_string(a() / 255.0);
-            if (auto dot = A.find('.'); dot)
-                str += A.substr(dot, 1 + 4);
-            else
-                str += A;
-            str += ')';
-            return str;
+            char str[MAX_STR_LENGTH];
+            // 透明度与 std::to_string 相同以 %f 格式化, 保留小数点起的 5 个字符
+            char alpha[16];
+            const int alpha_length = std::snprintf(alpha, sizeof(alpha), "%f", a() / 255.0);
+            const char *dot = std::find(alpha, alpha + alpha_length, '.');
+            const int length = std::snprintf(str, sizeof(str), "rgba(%u,%u,%u,%.*s)", r(), g(), b(),
+                                             static_cast<int>(std::min<ptrdiff_t>(alpha + alpha_length - dot, 5)), dot);
+            if (named && named->name.length() < static_cast<size_t>(length)) return put(named->name);
+            return put({str, static_cast<size_t>(length)});
         }
     }
 
     std::optional<std::string> Color::name() const {
-        auto name = named_colors_reverse.find(*this);
-        return name != named_colors_reverse.end() ? std::make_optional(name->second) : std::nullopt;
+        if (current_color) return std::string{CURRENT_COLOR};
+        const auto *named = findNamedColor(value);
+        return named ? std::make_optional(std::string{named->name}) : std::nullopt;
     }
 
 
@@ -287,6 +623,10 @@ namespace badge {
     }
 
     std::pair<std::string, std::string> Color::getColorHexPairForBackground() {
+        const auto [text, shadow] = getTextColorsForBackground();
+        return {std::string{text}, std::string{shadow}};
+    }
+    std::pair<std::string_view, std::string_view> Color::getTextColorsForBackground() const noexcept {
         static constexpr const double threshold = 0.69;
         if (brightness() <= threshold) {
             return {"#fff", "#010101"};
@@ -295,162 +635,10 @@ namespace badge {
         }
     }
 
-
-    const std::unordered_map<std::string_view, Color> Color::named_colors = {
-            {"aliceblue", {240, 248, 255}},
-            {"antiquewhite", {250, 235, 215}},
-            {"aqua", {0, 255, 255}},
-            {"aquamarine", {127, 255, 212}},
-            {"azure", {240, 255, 255}},
-            {"beige", {245, 245, 220}},
-            {"bisque", {255, 228, 196}},
-            {"black", {0, 0, 0}},
-            {"blanchedalmond", {255, 235, 205}},
-            {"blue", {0, 0, 255}},
-            {"blueviolet", {138, 43, 226}},
-            {"brown", {165, 42, 42}},
-            {"burlywood", {222, 184, 135}},
-            {"cadetblue", {95, 158, 160}},
-            {"chartreuse", {127, 255, 0}},
-            {"chocolate", {210, 105, 30}},
-            {"coral", {255, 127, 80}},
-            {"cornflowerblue", {100, 149, 237}},
-            {"cornsilk", {255, 248, 220}},
-            {"crimson", {220, 20, 60}},
-            {"cyan", {0, 255, 255}},
-            {"darkblue", {0, 0, 139}},
-            {"darkcyan", {0, 139, 139}},
-            {"darkgoldenrod", {184, 134, 11}},
-            {"darkgray", {169, 169, 169}},
-            {"darkgreen", {0, 100, 0}},
-            {"darkgrey", {169, 169, 169}},
-            {"darkkhaki", {189, 183, 107}},
-            {"darkmagenta", {139, 0, 139}},
-            {"darkolivegreen", {85, 107, 47}},
-            {"darkorange", {255, 140, 0}},
-            {"darkorchid", {153, 50, 204}},
-            {"darkred", {139, 0, 0}},
-            {"darksalmon", {233, 150, 122}},
-            {"darkseagreen", {143, 188, 143}},
-            {"darkslateblue", {72, 61, 139}},
-            {"darkslategray", {47, 79, 79}},
-            {"darkslategrey", {47, 79, 79}},
-            {"darkturquoise", {0, 206, 209}},
-            {"darkviolet", {148, 0, 211}},
-            {"deeppink", {255, 20, 147}},
-            {"deepskyblue", {0, 191, 255}},
-            {"dimgray", {105, 105, 105}},
-            {"dimgrey", {105, 105, 105}},
-            {"dodgerblue", {30, 144, 255}},
-            {"firebrick", {178, 34, 34}},
-            {"floralwhite", {255, 250, 240}},
-            {"forestgreen", {34, 139, 34}},
-            {"fuchsia", {255, 0, 255}},
-            {"gainsboro", {220, 220, 220}},
-            {"ghostwhite", {248, 248, 255}},
-            {"gold", {255, 215, 0}},
-            {"goldenrod", {218, 165, 32}},
-            {"gray", {128, 128, 128}},
-            {"green", {0, 128, 0}},
-            {"greenyellow", {173, 255, 47}},
-            {"grey", {128, 128, 128}},
-            {"honeydew", {240, 255, 240}},
-            {"hotpink", {255, 105, 180}},
-            {"indianred", {205, 92, 92}},
-            {"indigo", {75, 0, 130}},
-            {"ivory", {255, 255, 240}},
-            {"khaki", {240, 230, 140}},
-            {"lavender", {230, 230, 250}},
-            {"lavenderblush", {255, 240, 245}},
-            {"lawngreen", {124, 252, 0}},
-            {"lemonchiffon", {255, 250, 205}},
-            {"lightblue", {173, 216, 230}},
-            {"lightcoral", {240, 128, 128}},
-            {"lightcyan", {224, 255, 255}},
-            {"lightgoldenrodyellow", {250, 250, 210}},
-            {"lightgray", {211, 211, 211}},
-            {"lightgreen", {144, 238, 144}},
-            {"lightgrey", {211, 211, 211}},
-            {"lightpink", {255, 182, 193}},
-            {"lightsalmon", {255, 160, 122}},
-            {"lightseagreen", {32, 178, 170}},
-            {"lightskyblue", {135, 206, 250}},
-            {"lightslategray", {119, 136, 153}},
-            {"lightslategrey", {119, 136, 153}},
-            {"lightsteelblue", {176, 196, 222}},
-            {"lightyellow", {255, 255, 224}},
-            {"lime", {0, 255, 0}},
-            {"limegreen", {50, 205, 50}},
-            {"linen", {250, 240, 230}},
-            {"magenta", {255, 0, 255}},
-            {"maroon", {128, 0, 0}},
-            {"mediumaquamarine", {102, 205, 170}},
-            {"mediumblue", {0, 0, 205}},
-            {"mediumorchid", {186, 85, 211}},
-            {"mediumpurple", {147, 112, 219}},
-            {"mediumseagreen", {60, 179, 113}},
-            {"mediumslateblue", {123, 104, 238}},
-            {"mediumspringgreen", {0, 250, 154}},
-            {"mediumturquoise", {72, 209, 204}},
-            {"mediumvioletred", {199, 21, 133}},
-            {"midnightblue", {25, 25, 112}},
-            {"mintcream", {245, 255, 250}},
-            {"mistyrose", {255, 228, 225}},
-            {"moccasin", {255, 228, 181}},
-            {"navajowhite", {255, 222, 173}},
-            {"navy", {0, 0, 128}},
-            {"oldlace", {253, 245, 230}},
-            {"olive", {128, 128, 0}},
-            {"olivedrab", {107, 142, 35}},
-            {"orange", {255, 165, 0}},
-            {"orangered", {255, 69, 0}},
-            {"orchid", {218, 112, 214}},
-            {"palegoldenrod", {238, 232, 170}},
-            {"palegreen", {152, 251, 152}},
-            {"paleturquoise", {175, 238, 238}},
-            {"palevioletred", {219, 112, 147}},
-            {"papayawhip", {255, 239, 213}},
-            {"peachpuff", {255, 218, 185}},
-            {"peru", {205, 133, 63}},
-            {"pink", {255, 192, 203}},
-            {"plum", {221, 160, 221}},
-            {"powderblue", {176, 224, 230}},
-            {"purple", {128, 0, 128}},
-            {"rebeccapurple", {102, 51, 153}},
-            {"red", {255, 0, 0}},
-            {"rosybrown", {188, 143, 143}},
-            {"royalblue", {65, 105, 225}},
-            {"saddlebrown", {139, 69, 19}},
-            {"salmon", {250, 128, 114}},
-            {"sandybrown", {244, 164, 96}},
-            {"seagreen", {46, 139, 87}},
-            {"seashell", {255, 245, 238}},
-            {"sienna", {160, 82, 45}},
-            {"silver", {192, 192, 192}},
-            {"skyblue", {135, 206, 235}},
-            {"slateblue", {106, 90, 205}},
-            {"slategray", {112, 128, 144}},
-            {"slategrey", {112, 128, 144}},
-            {"snow", {255, 250, 250}},
-            {"springgreen", {0, 255, 127}},
-            {"steelblue", {70, 130, 180}},
-            {"tan", {210, 180, 140}},
-            {"teal", {0, 128, 128}},
-            {"thistle", {216, 191, 216}},
-            {"tomato", {255, 99, 71}},
-            {"turquoise", {64, 224, 208}},
-            {"violet", {238, 130, 238}},
-            {"wheat", {245, 222, 179}},
-            {"white", {255, 255, 255}},
-            {"whitesmoke", {245, 245, 245}},
-            {"yellow", {255, 255, 0}},
-            {"yellowgreen", {154, 205, 50}},
-    };
-    const std::unordered_map<Color, std::string, ColorHash> Color::named_colors_reverse = []() {
-        std::unordered_map<Color, std::string, ColorHash> ret;
-        for (const auto &[name, color]: named_colors) {
-            ret.try_emplace(color, name);
-        }
-        return ret;
-    }();
+    ResolvedColor::ResolvedColor(const Color &color) : brightness(color.brightness()), length_(color.to_chars(str_)) {
+        std::tie(text, shadow) = color.getTextColorsForBackground();
+    }
+    ResolvedColor::ResolvedColor(std::string_view css) : ResolvedColor(Color{css, false}) {
+        if (css.size() <= sizeof(str_)) length_ = css.copy(str_, css.size());
+    }
 }// namespace badge
\ No newline at end of file
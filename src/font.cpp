@@ -1,24 +1,141 @@
 #include "badgecpp/font.hpp"
+#include "badgecpp/fonts.h"
 #include "badgecpp/version.hpp"
 #include <algorithm>
-#include <codecvt>
+#include <array>
+#include <memory>
 #include <cstddef>
+#include <cstdint>
+#include <cstring>
 #include <fstream>
 #include <iostream>
-#include <locale>
 #include <string>
 #include <string_view>
+namespace {
+    constexpr char32_t REPLACEMENT_CHAR = 0xFFFD;
+
+    /// @brief 解码 s[i] 处的一个码点并前移 i
+    /// @details 非法序列(截断, 过长编码, 代理项, 超出范围)只消耗一个字节, 返回 U+FFFD
+    inline char32_t decode_utf8(std::string_view s, size_t &i) noexcept {
+        const auto b0 = static_cast<uint8_t>(s[i]);
+        if (b0 < 0x80) {
+            ++i;
+            return b0;
+        }
+        size_t len;
+        char32_t cp, min;
+        if ((b0 & 0xE0) == 0xC0) len = 2, cp = b0 & 0x1F, min = 0x80;
+        else if ((b0 & 0xF0) == 0xE0) len = 3, cp = b0 & 0x0F, min = 0x800;
+        else if ((b0 & 0xF8) == 0xF0) len = 4, cp = b0 & 0x07, min = 0x10000;
+        else {
+            ++i;
+            return REPLACEMENT_CHAR;
+        }
+        if (s.size() - i < len) {
+            ++i;
+            return REPLACEMENT_CHAR;
+        }
+        for (size_t k = 1; k < len; ++k) {
+            const auto b = static_cast<uint8_t>(s[i + k]);
+            if ((b & 0xC0) != 0x80) {
+                ++i;
+                return REPLACEMENT_CHAR;
+            }
+            cp = (cp << 6) | (b & 0x3F);
+        }
+        if (cp < min || cp > 0x10FFFF || (cp >= 0xD800 && cp <= 0xDFFF)) {
+            ++i;
+            return REPLACEMENT_CHAR;
+        }
+        i += len;
+        return cp;
+    }
+
+    /// @brief p 开始的16字节是否都是ASCII
+    inline bool is_ascii16(const char *p) noexcept {
+        uint64_t a, b;
+        std::memcpy(&a, p, 8);
+        std::memcpy(&b, p + 8, 8);
+        return ((a | b) & 0x8080808080808080ULL) == 0;
+    }
+}// namespace
 namespace badge {
 
-    std::u32string Font::toU32String(const std::string &str) {
-        static thread_local std::wstring_convert<std::codecvt_utf8<char32_t>, char32_t> converter;
-        return converter.from_bytes(str);
+    std::u32string Font::toU32String(std::string_view str) {
+        std::u32string result;
+        result.reserve(str.size());
+        for (size_t i = 0; i < str.size();) result.push_back(decode_utf8(str, i));
+        return result;
     }
 
-    Font::Font(std::vector<std::tuple<char32_t, char32_t, double>> widths, unsigned int size) : widths_(std::move(widths)), size_(size) {
+    Font::Font(std::vector<std::tuple<char32_t, char32_t, double>> widths, unsigned int size) : size_(size) {
+        build(std::move(widths));
         emWidth_ = widthOfCharCode(GUESS_CHAR, false);
     }
 
+    namespace {
+        /// @brief 运行时构建的查找表的存储
+        struct FontStorage {
+            std::array<double, 256> latin1{};
+            std::array<uint16_t, 256> bmp_pages{};
+            std::vector<uint16_t> bmp_cells{};
+            std::vector<double> values{};
+            std::vector<char32_t> range_lower{};
+            std::vector<char32_t> range_upper{};
+            std::vector<double> range_width{};
+        };
+    }// namespace
+
+    void Font::build(std::vector<Range> widths) {
+        auto storage = std::make_shared<FontStorage>();
+        auto &st = *storage;
+        st.range_lower.reserve(widths.size());
+        st.range_upper.reserve(widths.size());
+        st.range_width.reserve(widths.size());
+        for (const auto &[lower, upper, width]: widths) {
+            st.range_lower.push_back(lower);
+            st.range_upper.push_back(upper);
+            st.range_width.push_back(width);
+        }
+        tables_ = {};
+        tables_.range_lower = st.range_lower.data();
+        tables_.range_upper = st.range_upper.data();
+        tables_.range_width = st.range_width.data();
+        tables_.range_count = st.range_width.size();
+
+        // 直接索引表与页表中的值均由范围表查得, 与二分查找的结果完全一致
+        for (char32_t c = 0; c < st.latin1.size(); ++c)
+            st.latin1[c] = isControlChar(c) ? 0.0 : lookupRange(c);
+
+        st.bmp_pages.fill(NO_INDEX);
+        std::unordered_map<double, uint16_t> value_index;
+        for (const auto &[lower, upper, width]: widths) {
+            if (lower > 0xFFFF) continue;
+            const auto last_page = std::min<char32_t>(upper, 0xFFFF) >> 8;
+            for (auto page = std::max<char32_t>(lower, 0x100) >> 8; page <= last_page; ++page) {
+                if (st.bmp_pages[page] != NO_INDEX) continue;
+                const auto page_no = static_cast<uint16_t>(st.bmp_cells.size() >> 8);
+                st.bmp_pages[page] = page_no;
+                st.bmp_cells.resize(st.bmp_cells.size() + 0x100, NO_INDEX);
+                for (char32_t low = 0; low < 0x100; ++low) {
+                    const double w = lookupRange((page << 8) | low);
+                    if (w < 0) continue;
+                    auto [it, inserted] = value_index.try_emplace(w, static_cast<uint16_t>(st.values.size()));
+                    if (inserted) {
+                        if (st.values.size() >= NO_INDEX) throw std::runtime_error("[badgecpp::Front] Too many distinct widths");
+                        st.values.push_back(w);
+                    }
+                    st.bmp_cells[(size_t{page_no} << 8) | low] = it->second;
+                }
+            }
+        }
+        tables_.latin1 = st.latin1.data();
+        tables_.bmp_pages = st.bmp_pages.data();
+        tables_.bmp_cells = st.bmp_cells.data();
+        tables_.values = st.values.data();
+        storage_ = std::move(storage);
+    }
+
 
     Font Font::createByJsonFile(const std::string &filepath, unsigned int size) {
         std::ifstream file(filepath);
@@ -132,9 +249,8 @@ namespace badge {
             return x * factor;
         };
 
-        Font font;
-        font.size_ = size;
-        if (prepareElementsSize > 0) font.widths_.reserve(prepareElementsSize);
+        std::vector<Range> widths;
+        if (prepareElementsSize > 0) widths.reserve(prepareElementsSize);
         char next;
         next = next_char();
         tmp_assert(next == '[', MSG("'['", next));
@@ -146,13 +262,16 @@ namespace badge {
             auto value = read_double();
 
 
-            font.widths_.emplace_back(low, high, value);
+            widths.emplace_back(low, high, value);
 
 
             next = next_char();
             if (next == ']') break;
             tmp_assert(next == ',', MSG("','", next));
         }
+        Font font;
+        font.size_ = size;
+        font.build(std::move(widths));
         font.emWidth_ = font.widthOfCharCode(GUESS_CHAR, false);
         tmp_assert(font.emWidth_ > 0, std::string{"emWidth_ must be positive: '"} + GUESS_CHAR + "'(" + std::to_string(GUESS_CHAR) + "), got:" + std::to_string(font.emWidth_));
 #undef tmp_assert
@@ -160,17 +279,16 @@ namespace badge {
     }
 
 
+    double Font::lookupRange(char32_t charCode) const noexcept {
+        const auto *upper = tables_.range_upper;
+        const auto i = static_cast<size_t>(std::lower_bound(upper, upper + tables_.range_count, charCode) - upper);
+        if (i < tables_.range_count && tables_.range_lower[i] <= charCode) return tables_.range_width[i];
+        return UNKNOWN;
+    }
     double Font::widthOfCharCode(char32_t charCode, bool guess) const noexcept {
         if (isControlChar(charCode)) return 0.0;
-
-        auto it = std::lower_bound(widths_.begin(), widths_.end(), charCode,
-                                   [](const Range &range, char32_t value) {
-                                       return std::get<1>(range) < value;
-                                   });
-
-        if (it != widths_.end() && std::get<0>(*it) <= charCode && charCode <= std::get<1>(*it)) {
-            return std::get<2>(*it);
-        }
+        const double w = lookup(charCode);
+        if (w >= 0) return w;
         if (guess) return emWidth_;
         return -1;
     }
@@ -178,32 +296,78 @@ namespace badge {
     double Font::widthOfString(const std::u32string &str, bool guess) const noexcept {
         double width = 0.0;
         for (auto c: str) {
-            auto w = widthOfCharCode(c, guess);
-            if (w < 0) return -1;
+            // 控制字符在 latin1 表中为0, 无需单独判断
+            double w = lookup(c);
+            if (w < 0) {
+                if (!guess) return -1;
+                w = emWidth_;
+            }
             width += w;
         }
         return width;
     }
     double Font::widthOfString(const std::string &s, bool guess) const noexcept {
-        return widthOfString(toU32String(s), guess);
+        return widthOfString(std::string_view{s}, guess);
+    }
+    double Font::widthOfString(std::string_view s, bool guess) const noexcept {
+        size_t codepoints;
+        return widthOfString(s, guess, codepoints);
+    }
+    double Font::widthOfString(std::string_view s, bool guess, size_t &codepoints) const noexcept {
+        double width = 0.0;
+        codepoints = 0;
+        /// @brief 累加一个宽度, 未知且不猜测时返回 false
+        const auto add = [&](double w) {
+            if (w < 0) {
+                if (!guess) return false;
+                w = emWidth_;
+            }
+            width += w;
+            return true;
+        };
+        const size_t n = s.size();
+        size_t i = 0;
+        while (i < n) {
+            // ASCII 快速路径: 每次检查16字节, 直接查 latin1 表
+            if (n - i >= 16 && is_ascii16(s.data() + i)) {
+                for (const size_t end = i + 16; i < end; ++i)
+                    if (!add(tables_.latin1[static_cast<uint8_t>(s[i])])) return -1;
+                codepoints += 16;
+                continue;
+            }
+            const char32_t c = decode_utf8(s, i);
+            ++codepoints;
+            if (!add(lookup(c))) return -1;
+        }
+        return width;
     }
     double Font::widthOfString(const std::optional<std::string> &s, bool guess) const noexcept { return s ? widthOfString(*s, guess) : 0; }
     double Font::widthOfString(const std::optional<std::u32string> &s, bool guess) const noexcept { return s ? widthOfString(*s, guess) : 0; }
     unsigned int Font::size() const noexcept { return size_; }
     double Font::emWidth() const noexcept { return emWidth_; }
 
-    const Font *Fonts::get(const std::string &fontName) {
-        auto itr = instance().fontMap.find(fontName);
-        if (itr == instance().fontMap.end()) throw std::runtime_error("[badgecpp::Fonts::get] Not found font: " + fontName);
+    const Font *Fonts::getBuiltin(std::string_view fontName) noexcept {
+        for (const auto &builtin: _assets::fonts::BUILTIN_FONTS)
+            if (builtin.name == fontName) return &builtin.font;
+        return nullptr;
+    }
+    const Font *Fonts::get(std::string_view fontName) {
+        if (const auto *font = getBuiltin(fontName)) return font;
+        auto &fontMap = instance().fontMap;
+        auto itr = fontMap.find(std::string{fontName});
+        if (itr == fontMap.end()) throw std::runtime_error("[badgecpp::Fonts::get] Not found font: " + std::string{fontName});
         return &(itr->second);
     }
+    Fonts::Fonts() {
+        for (const auto &builtin: _assets::fonts::BUILTIN_FONTS) fontMap.try_emplace(std::string{builtin.name}, builtin.font);
+    }
     Fonts &Fonts::instance() {
         static Fonts fonts;
         return fonts;
     }
     const Font *Fonts::getDefault() { return get("verdana-11px-normal"); }
 
-    const std::unordered_map<std::string, Font> &Fonts::getFonts() noexcept { return instance().fontMap; }
+    const std::unordered_map<std::string, Font> &Fonts::getFonts() { return instance().fontMap; }
 
     void Fonts::createFont(std::string fontName, Font font) {
         if (fontName.empty()) throw std::runtime_error("[badgecpp::Fonts::createFont] Empty font name");
@@ -216,50 +380,4 @@ namespace badge {
         }
     }
 
-}// namespace badge
-
-#include "badgecpp/resources.h"
-namespace {
-    using namespace badge::_assets;
-    [[maybe_unused]] bool _ = ([]() {
-        static constexpr std::string_view prefix = "./badgecpp/fonts/";
-        static constexpr std::string_view suffix = ".json";
-        for (const auto &[filepath, id]: get_resource_list()) {
-            if (filepath.compare(0, prefix.size(), prefix) != 0 ||
-                filepath.compare(filepath.size() - suffix.size(), suffix.size(), suffix) != 0) continue;
-
-            std::string fontName = filepath.substr(prefix.size(), filepath.size() - prefix.size() - suffix.size());// exampe: "verdana-10px-bold"
-
-
-            // 解析字体大小
-            static constexpr char splitter = '-';
-            static constexpr std::string_view size_str = "px";
-
-            auto sizeStart = fontName.find(splitter);
-            if (sizeStart == std::string::npos) throw std::runtime_error("[badgecpp::Fonts::createFont] Invalid font name: " + fontName);
-            auto sizeUnit = fontName.find(size_str, sizeStart + 1);
-            if (sizeUnit == std::string::npos) throw std::runtime_error("[badgecpp::Fonts::createFont] Invalid font name: " + fontName);
-            auto sizeEnd = fontName.find(splitter, sizeUnit + size_str.size());
-            if (sizeEnd == std::string::npos) throw std::runtime_error("[badgecpp::Fonts::createFont] Invalid font name: " + fontName);
-
-            std::string sizeStr = fontName.substr(sizeStart + 1, sizeEnd - sizeStart - 1);
-            unsigned int size = 0;
-            try {
-                size = std::stoul(sizeStr);
-            } catch (const std::exception &e) {
-                throw std::runtime_error("[badgecpp::Fonts::createFont] Invalid font size: " + sizeStr + ", " + e.what() + ", file: " + filepath);
-            }
-
-            // 读取数据
-            const uint8_t *data = get_resource_data(id);
-            uint32_t sz = get_resource_size(id);
-
-            const std::string_view json{reinterpret_cast<const char *>(data), sz};
-
-            // 构造字体
-            badge::Fonts::createFont(fontName, badge::Font::createByJsonString(json, size));
-        }
-
-        return true;
-    })();
-}// namespace
\ No newline at end of file
+}// namespace badge
\ No newline at end of file
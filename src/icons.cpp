@@ -2,6 +2,7 @@
 #include "badgecpp/b64.hpp"
 #include "badgecpp/bbox.hpp"
 #include "badgecpp/color.hpp"
+#include "badgecpp/metrics.hpp"
 #include "badgecpp/resources.h"
 #include "badgecpp/version.hpp"
 #include <algorithm>
@@ -9,15 +10,63 @@
 #include <cstdint>
 #include <cstring>
 #include <iostream>
+#include <iterator>
 #include <memory>
+#include <mutex>
 #include <optional>
+#include <shared_mutex>
 #include <stdexcept>
+#include <string>
 #include <string_view>
+#include <vector>
 namespace {
     const std::string data_url_prefix = "data:image/svg+xml;base64,";
 
     constexpr std::string_view BUILTIN_REPLACE_TAG = "REPLACE=\"TAG\"";
 
+    /// @brief 二进制图标索引的常量, 与 tools/icons_tar.py 保持一致
+    constexpr uint32_t INDEX_MAGIC = 0x58444942;// 'BIDX'
+    constexpr uint32_t INDEX_VERSION = 2;
+    constexpr size_t INDEX_HEADER_SIZE = 7;///< magic, version, count, strings_size, table_count, node_count, node_icon_count
+    constexpr size_t RECORD_WORDS = 8;     ///< data, title, slug, hex 各一对 (offset, length)
+    constexpr size_t NODE_WORDS = 6;       ///< label_offset, label_length, first_child, child_count, icons_begin, icons_count
+    constexpr size_t FIELD_TITLE = 1;
+    constexpr size_t FIELD_SLUG = 2;
+    constexpr size_t FIELD_HEX = 3;
+
+    /// @brief 读取小端 uint32_t, 资源数据不保证对齐
+    inline uint32_t load_u32(const char *p) noexcept {
+        uint32_t v;
+        std::memcpy(&v, p, sizeof(v));
+        return v;
+    }
+
+    /// @brief FNV-1a + murmur3 fmix32, 与 tools/icons_tar.py 中的 icon_hash 一致
+    inline uint32_t icon_hash(std::string_view key, uint32_t seed) noexcept {
+        uint32_t h = 0x811C9DC5u ^ seed;
+        for (const char c: key) h = (h ^ static_cast<uint8_t>(c)) * 0x01000193u;
+        h ^= h >> 16;
+        h *= 0x85EBCA6Bu;
+        h ^= h >> 13;
+        h *= 0xC2B2AE35u;
+        h ^= h >> 16;
+        return h;
+    }
+
+    constexpr char ascii_lower(char c) noexcept { return c >= 'A' && c <= 'Z' ? static_cast<char>(c + ('a' - 'A')) : c; }
+    std::string ascii_lower(std::string_view str) {
+        std::string result(str);
+        for (auto &c: result) c = ascii_lower(c);
+        return result;
+    }
+    /// @brief a 忽略 ASCII 大小写后是否等于 lower (已为小写)
+    bool equals_nocase(std::string_view a, std::string_view lower) noexcept {
+        if (a.size() != lower.size()) return false;
+        for (size_t i = 0; i < a.size(); ++i)
+            if (ascii_lower(a[i]) != lower[i]) return false;
+        return true;
+    }
+
     /// @brief 将src中的tag替换为data, 假设 tag 出现在 src 中出现且只出现一次
     auto replace_tag(std::string_view src, size_t pos, std::string_view tag, const std::string &data) {
         std::string result;
@@ -62,21 +111,87 @@ namespace {
     }
 }// namespace
 namespace badge {
-    BuiltinIcon::BuiltinIcon(std::string_view title, Color color, std::string_view icon) : title(std::move(title)), color(std::move(color)), icon(std::move(icon)) {}
+    std::shared_ptr<const std::string> Icon::get_uri_shared(const std::optional<Color> &color, std::optional<BBox> pos) const {
+        return std::make_shared<const std::string>(get_uri(color, pos));
+    }
+    /// @brief 按 (color, pos) 缓存的uri
+    struct BuiltinIcon::UriCache {
+        struct Entry {
+            std::optional<Color> color;
+            std::optional<BBox> pos;
+            std::shared_ptr<const std::string> uri;
+        };
+        std::shared_mutex mutex;
+        std::vector<Entry> entries;///< 按插入顺序轮换淘汰
+        size_t next = 0;           ///< 下一个被替换的位置
+        size_t capacity = 8;       ///< 最多缓存的个数, 受 mutex 保护
+    };
+
+    BuiltinIcon::BuiltinIcon(std::string_view title, Color color, std::string_view icon)
+        : title(std::move(title)), color(std::move(color)), icon(std::move(icon)), uri_cache_(std::make_unique<UriCache>()) {}
     BuiltinIcon::BuiltinIcon(std::string_view title, std::string color, const void *data, size_t size)
         : title(std::move(title)),
           color(std::move(color), false),
-          icon(reinterpret_cast<const char *>(data), size) {}
+          icon(reinterpret_cast<const char *>(data), size),
+          uri_cache_(std::make_unique<UriCache>()) {}
+    BuiltinIcon::BuiltinIcon(const BuiltinIcon &other) : BuiltinIcon(other.title, other.color, other.icon) {
+        uri_cache_->capacity = other.uri_cache_capacity();
+    }
+    BuiltinIcon::BuiltinIcon(BuiltinIcon &&other) noexcept = default;
+    BuiltinIcon::~BuiltinIcon() = default;
 
     std::string BuiltinIcon::get_uri(const std::optional<Color> &color, std::optional<BBox> pos) const {
+        const auto encode = [](std::string_view svg) {
+            std::string uri;
+            uri.resize(data_url_prefix.size() + b64::encoded_size(svg.size()));
+            std::memcpy(uri.data(), data_url_prefix.data(), data_url_prefix.size());
+            b64::b64encode(reinterpret_cast<const uint8_t *>(svg.data()), svg.size(), uri.data() + data_url_prefix.size());
+            return uri;
+        };
         size_t replace_pos = icon.find(BUILTIN_REPLACE_TAG);
         if (replace_pos != std::string_view::npos) {
-            auto icon_ = replace_tag(icon, replace_pos, BUILTIN_REPLACE_TAG, build_attr(color, pos));
-            return data_url_prefix + b64::b64encode(reinterpret_cast<const uint8_t *>(icon_.data()), icon_.size());
+            return encode(replace_tag(icon, replace_pos, BUILTIN_REPLACE_TAG, build_attr(color, pos)));
         } else {
-            return data_url_prefix + b64::b64encode(reinterpret_cast<const uint8_t *>(icon.data()), icon.size());
+            return encode(icon);
         }
     }
+    std::shared_ptr<const std::string> BuiltinIcon::get_uri_shared(const std::optional<Color> &color, std::optional<BBox> pos) const {
+        BADGECPP_METRICS_PHASE(ICON_URI);
+        if (!uri_cache_) return Icon::get_uri_shared(color, pos);
+        auto &cache = *uri_cache_;
+        const auto match = [&](const UriCache::Entry &e) { return e.color == color && e.pos == pos; };
+        {
+            std::shared_lock lock{cache.mutex};
+            auto it = std::find_if(cache.entries.begin(), cache.entries.end(), match);
+            if (it != cache.entries.end()) return it->uri;
+        }
+
+        auto uri = std::make_shared<const std::string>(get_uri(color, pos));
+
+        std::unique_lock lock{cache.mutex};
+        auto it = std::find_if(cache.entries.begin(), cache.entries.end(), match);
+        if (it != cache.entries.end()) return it->uri;
+        if (cache.capacity == 0) return uri;
+        if (cache.entries.size() > cache.capacity) cache.entries.resize(cache.capacity);
+        if (cache.entries.size() < cache.capacity) {
+            cache.entries.push_back({color, pos, uri});
+        } else {
+            cache.next %= cache.capacity;
+            cache.entries[cache.next++] = {color, pos, uri};
+        }
+        return uri;
+    }
+    void BuiltinIcon::set_uri_cache_capacity(size_t capacity) {
+        if (!uri_cache_) return;
+        std::unique_lock lock{uri_cache_->mutex};
+        uri_cache_->capacity = capacity;
+        if (uri_cache_->entries.size() > capacity) uri_cache_->entries.resize(capacity);
+    }
+    size_t BuiltinIcon::uri_cache_capacity() const {
+        if (!uri_cache_) return 0;
+        std::shared_lock lock{uri_cache_->mutex};
+        return uri_cache_->capacity;
+    }
     std::string BuiltinIcon::get_svg(const std::optional<Color> &color, std::optional<BBox> pos) const {
         size_t replace_pos = icon.find(BUILTIN_REPLACE_TAG);
         if (replace_pos != std::string_view::npos) {
@@ -86,8 +201,14 @@ namespace badge {
         }
     }
     const std::vector<std::shared_ptr<BuiltinIcon>> &BuiltinIcons::icons() {
-        return instance().icons_;
+        auto &self = instance();
+        std::call_once(self.icons_once_, [&self]() {
+            self.icons_.reserve(self.size_);
+            for (size_t i = 0; i < self.size_; ++i) self.icons_.push_back(self.get(i));
+        });
+        return self.icons_;
     }
+    size_t BuiltinIcons::size() { return instance().size_; }
     Color BuiltinIcon::get_color() const { return color; }
     BuiltinIcons &BuiltinIcons::instance() {
         static BuiltinIcons instance;
@@ -101,62 +222,231 @@ namespace badge {
                 reinterpret_cast<const char *>(get_resource_data(ResId::__BADGECPP_ICON_IDX)),
                 _assets::get_resource_size(ResId::__BADGECPP_ICON_IDX));
 
-        const std::string_view data(
+        data_ = std::string_view(
                 reinterpret_cast<const char *>(get_resource_data(ResId::__BADGECPP_ICON_BIN)),
                 _assets::get_resource_size(ResId::__BADGECPP_ICON_BIN));
 
-        size_t ls = 0;// line start
-        size_t le = 0;// line end
-        while ((le = index.find('\n', le)) != std::string_view::npos) {
-            // f"{offset}\t{length}\t{hex}\t{title}\n"
-
-            bool ok = true;
-            auto s_o_l = index.find('\t', ls);// split offset and length
-            if (s_o_l == std::string_view::npos) ok = false;
-            auto s_l_h = ok ? index.find('\t', s_o_l + 1) : std::string_view::npos;// split length and hex
-            if (s_l_h == std::string_view::npos) ok = false;
-            auto s_h_t = ok ? index.find('\t', s_l_h + 1) : std::string_view::npos;// split hex and title
-            if (s_h_t == std::string_view::npos) ok = false;
-
-            if (!ok || s_h_t >= le) throw std::runtime_error("[badgecpp::Icons] Invalid icon data");
-
-            auto offset = std::stoul(std::string{index.substr(ls, s_o_l - ls)});
-            auto length = std::stoul(std::string{index.substr(s_o_l + 1, s_l_h - s_o_l - 1)});
-            std::string hex{index.substr(s_l_h + 1, s_h_t - s_l_h - 1)};
-            std::string title{};
-
-            icons_.emplace_back(std::make_shared<BuiltinIcon>(
-                    index.substr(s_h_t + 1, le - s_h_t - 1),                      // title
-                    '#' + std::string{index.substr(s_l_h + 1, s_h_t - s_l_h - 1)},// color
-                    data.data() + offset, length                                  // size
-                    ));
-
-            ls = le = le + 1;
+        // 格式见 tools/icons_tar.py, 此处只校验边界, 不复制数据
+        const auto invalid = []() { return std::runtime_error("[badgecpp::Icons] Invalid icon index"); };
+        if (index.size() < INDEX_HEADER_SIZE * 4 || load_u32(index.data()) != INDEX_MAGIC ||
+            load_u32(index.data() + 4) != INDEX_VERSION) throw invalid();
+        const size_t count = load_u32(index.data() + 8);
+        const size_t strings_size = load_u32(index.data() + 12);
+        const size_t table_count = load_u32(index.data() + 16);
+        const size_t node_count = load_u32(index.data() + 20);
+        const size_t node_icon_count = load_u32(index.data() + 24);
+        if (table_count < 3 || node_count == 0) throw invalid();
+
+        size_t pos = INDEX_HEADER_SIZE * 4;
+        /// @brief 取出 words 个 uint32_t, 越界时抛出异常
+        const auto take = [&](size_t words) {
+            if (words > (index.size() - pos) / 4) throw invalid();
+            const char *p = index.data() + pos;
+            pos += words * 4;
+            return p;
+        };
+        const char *table_header = take(table_count * 2);
+        records_ = take(count * RECORD_WORDS);
+        HashTable *tables[] = {&titles_, &slugs_, &lower_titles_};
+        for (size_t t = 0; t < table_count; ++t) {
+            const auto keys = load_u32(table_header + t * 8);
+            const auto buckets = load_u32(table_header + t * 8 + 4);
+            if (buckets == 0) throw invalid();
+            const char *disp = take(buckets);
+            const char *slots = take(keys);
+            if (t >= std::size(tables)) continue;// 忽略未知的表
+            *tables[t] = {disp, slots, keys, buckets};
+            for (uint32_t k = 0; k < keys; ++k)
+                if (load_u32(slots + k * 4) >= count) throw invalid();
+        }
+        nodes_ = take(node_count * NODE_WORDS);
+        node_icons_ = take(node_icon_count);
+        if (index.size() - pos != strings_size) throw invalid();
+        strings_ = index.substr(pos);
+
+        for (size_t i = 0; i < node_icon_count; ++i)
+            if (load_u32(node_icons_ + i * 4) >= count) throw invalid();
+        for (size_t i = 0; i < node_count; ++i) {
+            const char *n = nodes_ + i * NODE_WORDS * 4;
+            const size_t label_offset = load_u32(n), label_length = load_u32(n + 4);
+            const size_t first_child = load_u32(n + 8), child_count = load_u32(n + 12);
+            const size_t icons_begin = load_u32(n + 16), icons_count = load_u32(n + 20);
+            if (label_offset > strings_.size() || label_length > strings_.size() - label_offset ||
+                first_child > node_count || child_count > node_count - first_child ||
+                (child_count > 0 && first_child <= i) ||// 层序排列, 子节点总在父节点之后, 保证遍历有界
+                icons_begin > node_icon_count || icons_count > node_icon_count - icons_begin) throw invalid();
+        }
+        node_count_ = node_count;
+
+        for (size_t i = 0; i < count; ++i) {
+            const char *r = records_ + i * RECORD_WORDS * 4;
+            const size_t offset = load_u32(r), length = load_u32(r + 4);
+            if (offset > data_.size() || length > data_.size() - offset) throw invalid();
+            for (size_t field = 1; field < RECORD_WORDS / 2; ++field) {
+                const size_t s_offset = load_u32(r + field * 8), s_length = load_u32(r + field * 8 + 4);
+                if (s_offset > strings_.size() || s_length > strings_.size() - s_offset) throw invalid();
+                if (field == FIELD_TITLE || field == FIELD_SLUG) max_name_length_ = std::max(max_name_length_, s_length);
+            }
         }
 
-        std::sort(icons_.begin(), icons_.end(),
-                  [](const std::shared_ptr<BuiltinIcon> &a, const std::shared_ptr<BuiltinIcon> &b) -> bool {
-                      return a->title < b->title;
-                  });
+        size_ = count;
+        entries_ = std::make_unique<Entry[]>(size_);
+
+        if (version::is_debug())
+            std::cout << "[debug] [badgecpp::BuiltinIcons] Mapped " << size_ << " icons" << std::endl;
+    }
+    std::string_view BuiltinIcons::record_str(size_t index, size_t field) const {
+        const char *r = records_ + index * RECORD_WORDS * 4 + field * 8;
+        return strings_.substr(load_u32(r), load_u32(r + 4));
+    }
+    size_t BuiltinIcons::find(const HashTable &table, size_t field, std::string_view key, bool ignore_case) const {
+        if (table.keys == 0) return size_;
+        const auto bucket = icon_hash(key, 0) % table.buckets;
+        const auto slot = icon_hash(key, load_u32(table.disp + bucket * 4)) % table.keys;
+        const size_t index = load_u32(table.slots + slot * 4);
+        const auto value = record_str(index, field);
+        return (ignore_case ? equals_nocase(value, key) : value == key) ? index : size_;
+    }
+    BuiltinIcons::TrieNode BuiltinIcons::node(size_t index) const {
+        const char *n = nodes_ + index * NODE_WORDS * 4;
+        return {strings_.substr(load_u32(n), load_u32(n + 4)), load_u32(n + 8), load_u32(n + 12), load_u32(n + 16), load_u32(n + 20)};
+    }
+    uint32_t BuiltinIcons::node_icon(size_t index) const { return load_u32(node_icons_ + index * 4); }
+    const std::shared_ptr<BuiltinIcon> &BuiltinIcons::get(size_t index) {
+        auto &entry = entries_[index];
+        std::call_once(entry.once, [&]() {
+            const char *r = records_ + index * RECORD_WORDS * 4;
+            entry.icon = std::make_shared<BuiltinIcon>(record_str(index, FIELD_TITLE),
+                                                       '#' + std::string{record_str(index, FIELD_HEX)},
+                                                       data_.data() + load_u32(r), load_u32(r + 4));
+        });
+        return entry.icon;
     }
     std::shared_ptr<BuiltinIcon> BuiltinIcons::by_title(std::string_view title) {
-        // 使用 std::lower_bound 进行二分查找
-        const auto &icons = BuiltinIcons::icons();
-        auto it = std::lower_bound(icons.begin(), icons.end(), title,
-                                   [](const std::shared_ptr<BuiltinIcon> &icon, const std::string_view &value) -> bool {
-                                       return icon->title < value;
-                                   });
+        auto &self = instance();
+        const auto index = self.find(self.titles_, FIELD_TITLE, title);
+        return index < self.size_ ? self.get(index) : nullptr;
+    }
+    std::shared_ptr<BuiltinIcon> BuiltinIcons::by_slug(std::string_view slug) {
+        auto &self = instance();
+        const auto index = self.find(self.slugs_, FIELD_SLUG, slug);
+        return index < self.size_ ? self.get(index) : nullptr;
+    }
+    std::shared_ptr<BuiltinIcon> BuiltinIcons::by_title_nocase(std::string_view title) {
+        auto &self = instance();
+        const auto index = self.find(self.lower_titles_, FIELD_TITLE, ascii_lower(title), true);
+        return index < self.size_ ? self.get(index) : nullptr;
+    }
+    std::shared_ptr<BuiltinIcon> BuiltinIcons::lookup(std::string_view name) {
+        auto &self = instance();
+        auto index = self.find(self.titles_, FIELD_TITLE, name);
+        if (index == self.size_) index = self.find(self.slugs_, FIELD_SLUG, name);
+        if (index == self.size_) index = self.find(self.lower_titles_, FIELD_TITLE, ascii_lower(name), true);
+        return index < self.size_ ? self.get(index) : nullptr;
+    }
+    std::vector<std::shared_ptr<BuiltinIcon>> BuiltinIcons::complete(std::string_view prefix, size_t limit) {
+        auto &self = instance();
+        std::vector<std::shared_ptr<BuiltinIcon>> result;
+        if (limit == 0) return result;
+        const auto key = ascii_lower(prefix);
 
-        if (it != icons.end() && (*it)->title == title) return *it;
-        return nullptr;
+        // 沿前缀下降, 前缀可能终止于某条边的中间
+        uint32_t current = 0;
+        for (size_t matched = 0; matched < key.size();) {
+            const auto parent = self.node(current);
+            bool found = false;
+            for (uint32_t c = parent.first_child; c < parent.first_child + parent.child_count; ++c) {
+                const auto label = self.node(c).label;
+                if (label.empty() || label[0] != key[matched]) continue;
+                const auto common = std::min(label.size(), key.size() - matched);
+                if (label.compare(0, common, key, matched, common) != 0) return result;
+                matched += common;
+                current = c;
+                found = true;
+                break;
+            }
+            if (!found) return result;
+        }
+
+        // 按字典序先序遍历子树
+        std::vector<uint32_t> icons;
+        std::vector<uint32_t> stack{current};
+        while (!stack.empty() && icons.size() < limit) {
+            const auto n = self.node(stack.back());
+            stack.pop_back();
+            for (uint32_t i = 0; i < n.icons_count && icons.size() < limit; ++i) {
+                const auto icon = self.node_icon(n.icons_begin + i);
+                if (std::find(icons.begin(), icons.end(), icon) == icons.end()) icons.push_back(icon);
+            }
+            for (uint32_t c = n.child_count; c > 0; --c) stack.push_back(n.first_child + c - 1);
+        }
+        result.reserve(icons.size());
+        for (const auto icon: icons) result.push_back(self.get(icon));
+        return result;
     }
-}// namespace badge
+    std::vector<std::shared_ptr<BuiltinIcon>> BuiltinIcons::suggest(std::string_view name, size_t max_distance, size_t limit) {
+        auto &self = instance();
+        // 距离不小于长度差, 过长的 name 不可能命中, 也不必复制
+        if (name.size() > max_distance && name.size() - max_distance > self.max_name_length_) return {};
+        const auto key = ascii_lower(name);
+        const size_t m = key.size();
+        // 距离不超过 max(m, 名称长度), 更大的 max_distance 等价于此
+        const size_t d = std::min(max_distance, std::max(m, self.max_name_length_));
 
-namespace {
-    [[maybe_unused]] bool _ = ([]() {
-        [[maybe_unused]] auto size = badge::BuiltinIcons::instance().icons().size();
-        if (badge::version::is_debug())
-            std::cout << "[debug] [badgecpp::BuiltinIcons] Loaded " << size << " icons" << std::endl;
-        return true;
-    })();
-}
\ No newline at end of file
+        // 只保留 |i - j| <= d 的带: 深度 i 的行存放 j = i - d .. i + d, 位于 rows[i * band + (j - i + d)];
+        // 行数以前缀树的最大深度为上界, 与 name 的长度无关. 带外的值视为 d + 1
+        const size_t band = 2 * d + 1;
+        const size_t far = d + 1;
+        std::vector<size_t> rows((self.max_name_length_ + 1) * band, far);
+        for (size_t j = 0; j <= std::min(d, m); ++j) rows[j + d] = j;
+        std::vector<std::pair<size_t, uint32_t>> found;// (距离, 图标)
+
+        const auto visit = [&](const auto &self_visit, uint32_t index, size_t depth) -> void {
+            const auto n = self.node(index);
+            for (const char c: n.label) {
+                if (depth >= self.max_name_length_) return;// 索引损坏时不越界
+                const size_t *prev = rows.data() + depth * band;
+                size_t *cur = rows.data() + (depth + 1) * band;
+                ++depth;
+                size_t best = far;
+                for (size_t k = 0; k < band; ++k) {
+                    // 列 j = depth - d + k, 超出 [0, m] 的列在带外
+                    if (depth + k < d || depth + k - d > m) {
+                        cur[k] = far;
+                        continue;
+                    }
+                    const size_t j = depth + k - d;
+                    size_t value;
+                    if (j == 0) {
+                        value = depth;
+                    } else {
+                        value = prev[k] + (key[j - 1] != c);
+                        if (k + 1 < band) value = std::min(value, prev[k + 1] + 1);
+                        if (k > 0) value = std::min(value, cur[k - 1] + 1);
+                    }
+                    cur[k] = std::min(value, far);
+                    best = std::min(best, cur[k]);
+                }
+                if (best > d) return;
+            }
+            if (m + d >= depth && m + d - depth < band) {
+                const size_t distance = rows[depth * band + m + d - depth];
+                if (distance <= d)
+                    for (uint32_t i = 0; i < n.icons_count; ++i) found.emplace_back(distance, self.node_icon(n.icons_begin + i));
+            }
+            for (uint32_t c = 0; c < n.child_count; ++c) self_visit(self_visit, n.first_child + c, depth);
+        };
+        visit(visit, 0, 0);
+
+        std::sort(found.begin(), found.end());
+        std::vector<std::shared_ptr<BuiltinIcon>> result;
+        std::vector<uint32_t> icons;
+        for (const auto &[distance, icon]: found) {
+            if (icons.size() >= limit) break;
+            if (std::find(icons.begin(), icons.end(), icon) != icons.end()) continue;
+            icons.push_back(icon);
+            result.push_back(self.get(icon));
+        }
+        return result;
+    }
+}// namespace badge
\ No newline at end of file
@@ -0,0 +1,214 @@
+#include "badgecpp/metrics.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <mutex>
+#include <vector>
+namespace {
+    using namespace badge::metrics;
+
+    void writeHistogram(std::string &out, std::string_view name, std::string_view labels, const Histogram &h) {
+        const auto sample = [&](std::string_view suffix, std::string_view le, uint64_t value) {
+            out += name;
+            out += suffix;
+            out += '{';
+            out += labels;
+            if (!le.empty()) {
+                if (!labels.empty()) out += ',';
+                out += "le=\"";
+                out += le;
+                out += '"';
+            }
+            out += "} ";
+            out += std::to_string(value);
+            out += '\n';
+        };
+        uint64_t cumulative = 0;
+        for (size_t i = 0; i < Histogram::BUCKETS; ++i) {
+            cumulative += h.buckets[i];
+            const bool last = i + 1 == Histogram::BUCKETS;
+            sample("_bucket", last ? "+Inf" : std::to_string(Histogram::upperBound(i)), cumulative);
+        }
+        sample("_sum", {}, h.sum);
+        sample("_count", {}, h.count);
+    }
+    void writeHeader(std::string &out, std::string_view name, std::string_view help) {
+        out += "# HELP ";
+        out += name;
+        out += ' ';
+        out += help;
+        out += "\n# TYPE ";
+        out += name;
+        out += " histogram\n";
+    }
+
+#ifdef BADGECPP_METRICS
+    void subtract(Histogram &to, const Histogram &from) {
+        to.count -= from.count;
+        to.sum -= from.sum;
+        for (size_t i = 0; i < Histogram::BUCKETS; ++i) to.buckets[i] -= from.buckets[i];
+    }
+    template<typename F>
+    void forEach(Snapshot &s, const Snapshot &other, F f) {
+        for (size_t i = 0; i < PHASE_COUNT; ++i) f(s.phase_ns[i], other.phase_ns[i]);
+        f(s.render_ns, other.render_ns);
+        f(s.output_bytes, other.output_bytes);
+        f(s.output_nodes, other.output_nodes);
+    }
+
+    /// @brief 只有所属线程写入的直方图, 其他线程只读, 因此不需要读-改-写原子操作
+    struct LocalHistogram {
+        std::atomic<uint64_t> count{0};
+        std::atomic<uint64_t> sum{0};
+        std::array<std::atomic<uint64_t>, Histogram::BUCKETS> buckets{};
+
+        static void bump(std::atomic<uint64_t> &a, uint64_t v) noexcept {
+            a.store(a.load(std::memory_order_relaxed) + v, std::memory_order_relaxed);
+        }
+        void record(uint64_t value) noexcept {
+            bump(count, 1);
+            bump(sum, value);
+            bump(buckets[Histogram::bucketOf(value)], 1);
+        }
+        void addTo(Histogram &h) const noexcept {
+            h.count += count.load(std::memory_order_relaxed);
+            h.sum += sum.load(std::memory_order_relaxed);
+            for (size_t i = 0; i < Histogram::BUCKETS; ++i) h.buckets[i] += buckets[i].load(std::memory_order_relaxed);
+        }
+    };
+
+    /// @brief 一个线程的全部计数器
+    struct LocalCounters {
+        std::array<LocalHistogram, PHASE_COUNT> phase_ns;
+        LocalHistogram render_ns, output_bytes, output_nodes;
+
+        void addTo(Snapshot &s) const noexcept {
+            for (size_t i = 0; i < PHASE_COUNT; ++i) phase_ns[i].addTo(s.phase_ns[i]);
+            render_ns.addTo(s.render_ns);
+            output_bytes.addTo(s.output_bytes);
+            output_nodes.addTo(s.output_nodes);
+        }
+    };
+
+    struct Registry {
+        std::mutex mutex;
+        std::vector<const LocalCounters *> live;///< 存活线程的计数器
+        Snapshot retired;                       ///< 已退出线程的计数
+        Snapshot base;                          ///< reset 时的计数, 快照时扣除
+        std::atomic<Sink *> sink{nullptr};
+    };
+    /// @brief 不析构: 线程可能在静态对象析构之后才退出
+    Registry &registry() {
+        static Registry *const instance = new Registry;
+        return *instance;
+    }
+
+    /// @brief 线程首次记录时注册, 退出时把计数并入 retired
+    struct ThreadCounters {
+        LocalCounters counters;
+        ThreadCounters() {
+            auto &r = registry();
+            std::lock_guard lock{r.mutex};
+            r.live.push_back(&counters);
+        }
+        ~ThreadCounters() {
+            auto &r = registry();
+            std::lock_guard lock{r.mutex};
+            counters.addTo(r.retired);
+            r.live.erase(std::find(r.live.begin(), r.live.end(), &counters));
+        }
+    };
+    LocalCounters &local() {
+        thread_local ThreadCounters instance;
+        return instance.counters;
+    }
+    /// @brief 当前线程正在进行的渲染
+    thread_local RenderSample *current = nullptr;
+
+    /// @brief 未合并 base 的原始计数
+    Snapshot collect(Registry &r) {
+        Snapshot s = r.retired;
+        for (const auto *counters: r.live) counters->addTo(s);
+        return s;
+    }
+#endif
+}// namespace
+namespace badge::metrics {
+    std::string exposition(const Snapshot &snapshot) {
+        std::string out;
+        writeHeader(out, "badgecpp_phase_duration_nanoseconds", "Time spent in each rendering phase; phases may nest.");
+        for (size_t i = 0; i < PHASE_COUNT; ++i) {
+            std::string labels = "phase=\"";
+            labels += phase_str(static_cast<Phase>(i));
+            labels += '"';
+            writeHistogram(out, "badgecpp_phase_duration_nanoseconds", labels, snapshot.phase_ns[i]);
+        }
+        writeHeader(out, "badgecpp_render_duration_nanoseconds", "Time spent in a complete badge render.");
+        writeHistogram(out, "badgecpp_render_duration_nanoseconds", {}, snapshot.render_ns);
+        writeHeader(out, "badgecpp_output_bytes", "Size of each produced svg document.");
+        writeHistogram(out, "badgecpp_output_bytes", {}, snapshot.output_bytes);
+        writeHeader(out, "badgecpp_output_nodes", "Number of elements in each produced svg document.");
+        writeHistogram(out, "badgecpp_output_nodes", {}, snapshot.output_nodes);
+        return out;
+    }
+
+#ifdef BADGECPP_METRICS
+    void setSink(Sink *sink) noexcept {
+        registry().sink.store(sink, std::memory_order_release);
+    }
+    Snapshot snapshot() {
+        auto &r = registry();
+        std::lock_guard lock{r.mutex};
+        Snapshot s = collect(r);
+        forEach(s, r.base, subtract);
+        return s;
+    }
+    void reset() {
+        auto &r = registry();
+        std::lock_guard lock{r.mutex};
+        r.base = collect(r);
+    }
+
+    namespace detail {
+        uint64_t now() noexcept {
+            return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                                 std::chrono::steady_clock::now().time_since_epoch())
+                                                 .count());
+        }
+        void recordPhase(Phase phase, uint64_t ns) noexcept {
+            const auto i = static_cast<size_t>(phase);
+            local().phase_ns[i].record(ns);
+            if (current) current->phase_ns[i] += ns;
+        }
+        void recordOutput(std::string_view out) noexcept {
+            uint64_t nodes = 0;
+            for (const char *p = out.data(), *end = p + out.size();
+                 (p = static_cast<const char *>(std::memchr(p, '<', static_cast<size_t>(end - p)))) != nullptr; ++p) {
+                if (p + 1 < end && p[1] != '/' && p[1] != '!' && p[1] != '?') ++nodes;
+            }
+            auto &counters = local();
+            counters.output_bytes.record(out.size());
+            counters.output_nodes.record(nodes);
+            if (current) {
+                current->bytes += out.size();
+                current->nodes += nodes;
+            }
+        }
+
+        RenderScope::RenderScope() noexcept : outer_(current), start_(now()) {
+            current = &sample_;
+        }
+        RenderScope::~RenderScope() {
+            sample_.total_ns = now() - start_;
+            current = outer_;
+            local().render_ns.record(sample_.total_ns);
+            if (auto *sink = registry().sink.load(std::memory_order_acquire)) sink->onRender(sample_);
+        }
+    }// namespace detail
+#else
+    void setSink([[maybe_unused]] Sink *sink) noexcept {}
+    Snapshot snapshot() { return {}; }
+    void reset() {}
+#endif
+}// namespace badge::metrics
\ No newline at end of file
@@ -1,12 +1,15 @@
 #include "badgecpp/render.hpp"
 #include "badgecpp/color.hpp"
 #include "badgecpp/font.hpp"
+#include "badgecpp/metrics.hpp"
 #include "badgecpp/render.impl.hpp"
 #include "badgecpp/util.hpp"
 #include "badgecpp/xml.hpp"
+#include <initializer_list>
 #include <optional>
 #include <stdexcept>
 #include <string>
+#include <string_view>
 #include <sys/types.h>
 namespace {
     using namespace badge;
@@ -15,262 +18,331 @@ namespace {
     constexpr unsigned int LOGO_LABEL_PADDING = 3;
     constexpr unsigned int LOGO_HEIGHT = 14;
     constexpr unsigned int DEFAULT_LOGO_WIDTH = 14;
-    const std::string DEFAULT_LABEL_COLOR = "#555";
-    const std::string DEFAULT_MESSAGE_COLOR = "#4c1";
+    /// @brief 默认颜色, 首次使用时解析
+    const ResolvedColor &defaultLabelColor() {
+        static const ResolvedColor color{"#555"};
+        return color;
+    }
+    const ResolvedColor &defaultMessageColor() {
+        static const ResolvedColor color{"#4c1"};
+        return color;
+    }
 
 
-    const Font &FONT = *Fonts::get("verdana-11px-normal");
-    const std::string FONT_FAMILY = "Verdana,Geneva,DejaVu Sans,sans-serif";
+    /// @brief 首次使用时才查找字体, 不依赖跨编译单元的静态初始化顺序
+    const Font &font() {
+        static const Font &font = *Fonts::get("verdana-11px-normal");
+        return font;
+    }
+    constexpr std::string_view FONT_FAMILY = "Verdana,Geneva,DejaVu Sans,sans-serif";
 
     // https://github.com/badges/shields/pull/1132
     constexpr unsigned int FONT_SIZE_UP = 10;      ///< 放大10倍
-    const std::string FONT_SIZE_DOWN = "scale(.1)";///< 缩小到10%
-
-}// namespace
-namespace badge {
+    constexpr std::string_view FONT_SIZE_DOWN = "scale(.1)";///< 缩小到10%
 
+    /// @brief 无障碍文本 "label: message" 中 label 之后的分隔符
+    std::string_view accessibleSeparator(const BadgeView &badge) {
+        return badge.label_ && badge.message_ ? ": "
+               : badge.label_                 ? ":"
+                                              : "";
+    }
 
-    Render::Render(const Badge &badge) : badge(badge) {
+    // 公共片段模板, 与 font() 一样在首次使用时才解析, 不依赖跨编译单元的静态初始化顺序
+    const XmlTemplate &svgHead() {
+        static const XmlTemplate t{R"svg(<svg xmlns="http://www.w3.org/2000/svg" xmlns:xlink="http://www.w3.org/1999/xlink" width="$0" height="$1" role="img" aria-label="$2$3$4")svg"};
+        return t;
     }
-    Xml Render::render() {
-        calcValues();
-        return renderSvg();
+    const XmlTemplate &clipPath() {
+        static const XmlTemplate t{R"svg(<clipPath id="r$0"><rect width="$1" height="$2" rx="$3" fill="#fff"/></clipPath>)svg"};
+        return t;
+    }
+    const XmlTemplate &clipPathGroup() {
+        static const XmlTemplate t{R"svg(<g clip-path="url(#r$0)")svg"};
+        return t;
+    }
+    const XmlTemplate &crispEdgesGroup() {
+        static const XmlTemplate t{R"svg(<g shape-rendering="crispEdges")svg"};
+        return t;
+    }
+    const XmlTemplate &backgroundRects() {
+        static const XmlTemplate t{R"svg(<rect width="$0" height="$1" fill="$2"/><rect x="$0" width="$3" height="$1" fill="$4"/>)svg"};
+        return t;
+    }
+    const XmlTemplate &backgroundGradient() {
+        static const XmlTemplate t{R"svg(<rect width="$0" height="$1" fill="url(#s$2)"/>)svg"};
+        return t;
+    }
+    const XmlTemplate &foregroundGroup() {
+        static const XmlTemplate t{R"svg(<g fill="#f0f" text-anchor="middle" font-family="$0" text-rendering="geometricPrecision" font-size="$1")svg"};
+        return t;
+    }
+    const XmlTemplate &logo() {
+        static const XmlTemplate t{R"svg(<image x="$0" y="$1" width="$2" height="$3" xlink:href="$4"/>)svg"};
+        return t;
+    }
+    const XmlTemplate &text() {
+        static const XmlTemplate t{R"svg(<text x="$0" y="$1" fill="$2" transform="$3" textLength="$4")svg"};
+        return t;
+    }
+    const XmlTemplate &shadowText() {
+        static const XmlTemplate t{R"svg(<text aria-hidden="true" x="$0" y="$1" fill="$2" fill-opacity=".3" transform="$3" textLength="$4"/>)svg"};
+        return t;
+    }
+    const XmlTemplate &flatGradient() {
+        static const XmlTemplate t{R"svg(<linearGradient id="s$0" x2="0" y2="100%"><stop offset="0" stop-color="#bbb" stop-opacity=".1"/><stop offset="1" stop-opacity=".1"/></linearGradient>)svg"};
+        return t;
+    }
+    const XmlTemplate &plasticGradient() {
+        static const XmlTemplate t{R"svg(<linearGradient id="s$0" x2="0" y2="100%">)svg"
+                                   R"svg(<stop offset="0" stop-color="#fff" stop-opacity=".7"/>)svg"
+                                   R"svg(<stop offset=".1" stop-color="#aaa" stop-opacity=".1"/>)svg"
+                                   R"svg(<stop offset=".9" stop-color="#000" stop-opacity=".3"/>)svg"
+                                   R"svg(<stop offset="1" stop-color="#000" stop-opacity=".5"/>)svg"
+                                   R"svg(</linearGradient>)svg"};
+        return t;
     }
-    void Render::calcValues() {
-        hasLogo = static_cast<bool>(badge.logo_);
-        hasLabel = bool(badge.label_);
-        hasMessage = bool(badge.message_);
-
-        logo_width = get_logo_width();
-
-        label_width = get_str_width(badge.label_, TextType::LABEL);
-
-        label_margin =
-                hasLogo && hasLabel ? 1 + logo_width + LOGO_LABEL_PADDING
-                : hasLabel          ? 1
-                                    : 0;
-
-        left_width =
-                hasLogo && hasLabel ? HORIZ_PADDING + logo_width + LOGO_LABEL_PADDING + label_width + HORIZ_PADDING
-                : hasLogo           ? HORIZ_PADDING + logo_width + HORIZ_PADDING
-                : hasLabel          ? HORIZ_PADDING + label_width + HORIZ_PADDING
-                                    : 0;
-
-        message_width = get_str_width(badge.message_, TextType::MESSAGE);
-
-        message_margin = left_width - (hasMessage && left_width > 0 ? 1 : 0);
-
-        right_width =
-                hasMessage ? HORIZ_PADDING + message_width + HORIZ_PADDING
-                           : 0;
 
-        height = get_height();
-        width = left_width + right_width > 0 ? left_width + right_width : 0;
+    /// @brief 样式 R 的渲染器单例; 渲染器没有数据成员, 可以被所有线程共享
+    template<typename R>
+    const R &instance() {
+        static const R render{};
+        return render;
+    }
+}// namespace
+namespace badge {
 
-        accessible_test = get_accessible_text();
 
-        idSuffix = badge.id_suffix_ ? *badge.id_suffix_ : "";
+    Xml Render::render(const Layout &l) const {
+        return renderTree(*this, l);
     }
-    Xml Render::renderSvg() const {
-        Xml svg("svg", {
-                               {"xmlns", "http://www.w3.org/2000/svg"},
-                               {"xmlns:xlink", "http://www.w3.org/1999/xlink"},
-                               {"width", std::to_string(width)},
-                               {"height", std::to_string(height)},
-                       });
-
-        //if (!badge.link_)
+    void Render::render(const Layout &l, std::string &out) const {
+        renderStream(*this, l, out);
+    }
+    pmr::Xml Render::render(const Layout &l, std::pmr::memory_resource *resource) const {
+        return renderTree(*this, l, resource);
+    }
+    template<typename Self>
+    Layout Render::timedLayout(const Self &self, const BadgeView &badge) {
+        BADGECPP_METRICS_PHASE(CALC_VALUES);
+        return self.layout(badge);
+    }
+    template<typename Self>
+    Xml Render::renderTree(const Self &self, const Layout &l) {
+        BADGECPP_METRICS_PHASE(BUILD_TREE);
+        Xml root;
+        XmlBuilder b{root};
+        writeSvg(self, l, b);
+        return root;
+    }
+    template<typename Self>
+    void Render::renderStream(const Self &self, const Layout &l, std::string &out) {
+        [[maybe_unused]] const size_t begin = out.size();
         {
-            svg.addAttr("role", "img");
-            svg.addAttr("aria-label", accessible_test);
+            BADGECPP_METRICS_PHASE(WRITE_STREAM);
+            XmlWriter w{out};
+            writeSvg(self, l, w);
+        }
+        BADGECPP_METRICS_OUTPUT(std::string_view{out}.substr(begin));
+    }
+    template<typename Self>
+    pmr::Xml Render::renderTree(const Self &self, const Layout &l, std::pmr::memory_resource *resource) {
+        BADGECPP_METRICS_PHASE(BUILD_TREE);
+        pmr::Xml root{resource};
+        pmr::XmlBuilder b{root};
+        writeSvg(self, l, b);
+        return root;
+    }
+    template<typename Self>
+    void Render::calcLayout(const Self &self, Layout &l) {
+        const BadgeView &badge = l.badge;
+        l.hasLogo = static_cast<bool>(badge.logo_);
+        l.hasLabel = bool(badge.label_);
+        l.hasMessage = bool(badge.message_);
+
+        l.logo_width = self.get_logo_width(l);
+
+        l.label_width = self.get_str_width(l, badge.label_, TextType::LABEL);
+
+        l.label_margin =
+                l.hasLogo && l.hasLabel ? 1 + l.logo_width + LOGO_LABEL_PADDING
+                : l.hasLabel            ? 1
+                                        : 0;
+
+        l.left_width =
+                l.hasLogo && l.hasLabel ? HORIZ_PADDING + l.logo_width + LOGO_LABEL_PADDING + l.label_width + HORIZ_PADDING
+                : l.hasLogo             ? HORIZ_PADDING + l.logo_width + HORIZ_PADDING
+                : l.hasLabel            ? HORIZ_PADDING + l.label_width + HORIZ_PADDING
+                                        : 0;
+
+        l.message_width = self.get_str_width(l, badge.message_, TextType::MESSAGE);
+
+        l.message_margin = l.left_width - (l.hasMessage && l.left_width > 0 ? 1 : 0);
+
+        l.right_width =
+                l.hasMessage ? HORIZ_PADDING + l.message_width + HORIZ_PADDING
+                             : 0;
+
+        l.height = self.get_height();
+        l.width = l.left_width + l.right_width > 0 ? l.left_width + l.right_width : 0;
+
+        if (self.uses_colors()) {
+            if (badge.label_color_) l.label_color = ResolvedColor{*badge.label_color_};
+            else l.label_color = defaultLabelColor();
+            if (badge.message_color_) l.message_color = ResolvedColor{*badge.message_color_};
+            else l.message_color = defaultMessageColor();
         }
 
-        svg.addContent(get_content());
-        return svg;
+        l.idSuffix = badge.id_suffix_ ? std::string_view{*badge.id_suffix_} : std::string_view{};
+    }
+    template<typename Self, typename Writer>
+    void Render::writeSvg(const Self &self, const Layout &l, Writer &w) {
+        const auto &badge = l.badge;
+        w.fill(svgHead(), {l.width, l.height, badge.label_.value_or(""), accessibleSeparator(badge), badge.message_.value_or("")});
+        self.write_content(l, w);
+        w.close("svg");
     }
-    unsigned int Render::get_str_width(const std::optional<std::string> &str, [[maybe_unused]] TextType tt) const {
+    unsigned int Render::get_str_width([[maybe_unused]] const Layout &l, const std::optional<std::string_view> &str, [[maybe_unused]] TextType tt) const {
         if (!str) return 0;
-        auto width = static_cast<unsigned int>(FONT.widthOfString(*str));
+        auto width = static_cast<unsigned int>(font().widthOfString(*str));
         return width % 2 ? width : (width + 1);
     }
-    std::string Render::get_accessible_text() const {
-        return badge.label_ && badge.message_ ? *badge.label_ + ": " + *badge.message_
-               : badge.label_                 ? *badge.label_ + ":"
-               : badge.message_               ? *badge.message_
-                                              : "";
-    }
-    unsigned int Render::get_logo_width() const {
-        return badge.logo_ ? (badge.logo_width_ ? *badge.logo_width_ : DEFAULT_LOGO_WIDTH) : 0;
-    }
-    Xml Render::getClipPathElement(int rx) const {
-        return {
-                "clipPath",
-                {{"id", "r" + idSuffix}},
-                Xml{
-                        "rect",
-                        {
-                                {"width", std::to_string(width)},
-                                {"height", std::to_string(height)},
-                                {"rx", std::to_string(rx)},
-                                {"fill", "#fff"},
-                        },
-                }};
-    }
-    Xml Render::getBackgroundGroupElement(bool withGradient, Xml::Attrs attrs) const {
-        Xml node{
-                "g",
-                std::move(attrs),
-                //left react
-                Xml{
-                        "rect",
-                        {
-                                {"width", std::to_string(left_width)},
-                                {"height", std::to_string(height)},
-                                {"fill", badge.label_color_ ? badge.label_color_->to_str() : DEFAULT_LABEL_COLOR},
-                        },
-                },
-                //right react
-                Xml{
-                        "rect",
-                        {
-                                {"x", std::to_string(left_width)},
-                                {"width", std::to_string(right_width)},
-                                {"height", std::to_string(height)},
-                                {"fill", badge.message_color_ ? badge.message_color_->to_str() : DEFAULT_MESSAGE_COLOR},
-                        },
-                },
-        };
-        if (withGradient) {
-            node.addContent(Xml{
-                    "rect",
-                    {
-                            {"width", std::to_string(width)},
-                            {"height", std::to_string(height)},
-                            {"fill", "url(#s" + idSuffix + ")"},
-                    },
-            });
-        }
-
-        return node;
-    }
-    Xml Render::getForegroundGroupElement() const {
-        return {
-                "g",
-                {
-                        {"fill", "#f0f"},// TODO 自定义颜色
-                        {"text-anchor", "middle"},
-                        {"font-family", FONT_FAMILY},
-                        {"text-rendering", "geometricPrecision"},
-                        {"font-size", std::to_string(FONT_SIZE_UP * FONT.size())},
-                },
-                getLogoElement(HORIZ_PADDING, height),
-                getLabelElement(),
-                getMessageElement(),
-        };
-    }
-    Xml Render::getLogoElement(unsigned int horizPadding, unsigned int badgeHeight) const {
-        if (!badge.logo_) return {};
-        return {
-                "image",
-                {
-                        {"x", std::to_string(horizPadding)},
-                        {"y", std::to_string(0.5 * (badgeHeight - LOGO_HEIGHT))},
-                        {"width", std::to_string(logo_width)},
-                        {"height", std::to_string(LOGO_HEIGHT)},
-                        {"xlink:href", badge.logo_->get_uri(badge.logo_color_
-                                                                    ? *badge.logo_color_
-                                                                    : badge.logo_->get_color())},
-                },
-        };
-    }
-    Xml Render::getTextElement(unsigned int left_margin, std::optional<std::string> content, const std::string &color, unsigned int text_width,
-                               std::optional<std::string> link, unsigned int link_width) const {
-        if (!content) return {};
-        const auto [textColor, shadowColor] = Color{color}.getColorHexPairForBackground();
-
-        const auto x = badge::dtos(FONT_SIZE_UP * (left_margin + 0.5 * text_width + HORIZ_PADDING));
+    unsigned int Render::get_logo_width(const Layout &l) const {
+        return l.badge.logo_ ? (l.badge.logo_width_ ? *l.badge.logo_width_ : DEFAULT_LOGO_WIDTH) : 0;
+    }
+    template<typename Writer>
+    void Render::writeClipPathElement(const Layout &l, Writer &w, int rx) const {
+        w.fill(clipPath(), {l.idSuffix, l.width, l.height, static_cast<unsigned int>(rx)});
+    }
+    template<typename Writer>
+    void Render::writeBackgroundGroupElement(const Layout &l, Writer &w, bool withGradient, const XmlTemplate &groupStart) const {
+        w.fill(groupStart, {l.idSuffix});
+        //left react, right react
+        w.fill(backgroundRects(), {l.left_width, l.height, l.label_color.str(), l.right_width, l.message_color.str()});
+        if (withGradient) w.fill(backgroundGradient(), {l.width, l.height, l.idSuffix});
+        w.close("g");
+    }
+    template<typename Writer>
+    void Render::writeForegroundGroupElement(const Layout &l, Writer &w) const {
+        w.fill(foregroundGroup(), {FONT_FAMILY, FONT_SIZE_UP * font().size()});// TODO 自定义颜色
+        writeLogoElement(l, w, HORIZ_PADDING, l.height);
+        writeLabelElement(l, w);
+        writeMessageElement(l, w);
+        w.close("g");
+    }
+    template<typename Writer>
+    void Render::writeLogoElement(const Layout &l, Writer &w, unsigned int horizPadding, unsigned int badgeHeight) const {
+        if (!l.badge.logo_) return;
+        const auto y = NumberString::trimmed(0.5 * (badgeHeight - LOGO_HEIGHT));
+        const auto uri = l.badge.logo_->get_uri_shared(l.badge.logo_color_
+                                                               ? *l.badge.logo_color_
+                                                               : l.badge.logo_->get_color());
+        w.fill(logo(), {horizPadding, y, l.logo_width, LOGO_HEIGHT, *uri});
+    }
+    template<typename Writer>
+    void Render::writeTextElement(const Layout &l, Writer &w, unsigned int left_margin, std::optional<std::string_view> content, const ResolvedColor &color, unsigned int text_width,
+                                  const std::optional<std::string> &link, unsigned int link_width) const {
+        if (!content) return;
+        const auto textColor = color.text, shadowColor = color.shadow;
+
+        const auto x = NumberString::trimmed(FONT_SIZE_UP * (left_margin + 0.5 * text_width + HORIZ_PADDING));
         const auto vertical_margin = get_vertical_margin();
 
-        Xml node;
-
         if (link) {
-            node.setName("a");
-            node.addAttr("target", "_blank");
-            node.addAttr("xlink:href", *link);
-            node.addContent(Xml{
-                    "rect",
-                    {
-                            {"x", std::to_string(left_margin > 1 ? left_margin + 1 : 0)},
-                            {"width", std::to_string(link_width)},
-                            {"height", std::to_string(height)},
-                            {"fill", "rgba(0,0,0,0)"},
-                    }});
+            w.open("a")
+                    .attr("target", "_blank")
+                    .attr("xlink:href", *link);
+            w.open("rect")
+                    .attr("x", NumberString(left_margin > 1 ? left_margin + 1 : 0))
+                    .attr("width", NumberString(link_width))
+                    .attr("height", NumberString(l.height))
+                    .attr("fill", "rgba(0,0,0,0)")
+                    .close("rect");
         }
 
-        node.addContent(Xml{
-                // text
-                "text",
-                {
-                        {"x", x},
-                        {"y", std::to_string(140 + vertical_margin)},
-                        {"fill", textColor},
-                        {"transform", FONT_SIZE_DOWN},
-                        {"textLength", std::to_string(FONT_SIZE_UP * text_width)},
-                },
-                *content,
-        });
+        // text
+        w.fill(text(), {x, 140 + vertical_margin, textColor, FONT_SIZE_DOWN, FONT_SIZE_UP * text_width})
+                .text(*content)
+                .close("text");
         if (text_has_shadow()) {
-            node.addContent(Xml{
-                    // shadowText
-                    "text",
-                    {
-                            {"aria-hidden", "true"},
-                            {"x", x},
-                            {"y", std::to_string(150 + vertical_margin)},
-                            {"fill", shadowColor},
-                            {"fill-opacity", ".3"},
-                            {"transform", FONT_SIZE_DOWN},
-                            {"textLength", std::to_string(FONT_SIZE_UP * text_width)},
-                    },
-            });
+            // shadowText
+            w.fill(shadowText(), {x, 150 + vertical_margin, shadowColor, FONT_SIZE_DOWN, FONT_SIZE_UP * text_width});
         }
 
-
-        return node;
-    }
-    Xml Render::getLabelElement() const {
-        return getTextElement(
-                label_margin,
-                badge.label_,
-                badge.label_color_ ? badge.label_color_->to_str() : DEFAULT_LABEL_COLOR,
-                label_width,
-                left_link,
-                left_width);
-    }
-    Xml Render::getMessageElement() const {
-        return getTextElement(
-                message_margin,
-                badge.message_,
-                badge.message_color_ ? badge.message_color_->to_str() : DEFAULT_MESSAGE_COLOR,
-                message_width,
-                right_link,
-                right_width);
-    }
-
-
-    std::unique_ptr<Render> Render::create(const Badge &badge) {
-        switch (badge.style_) {
+        if (link) w.close("a");
+    }
+    template<typename Writer>
+    void Render::writeLabelElement(const Layout &l, Writer &w) const {
+        writeTextElement(
+                l,
+                w,
+                l.label_margin,
+                l.badge.label_,
+                l.label_color,
+                l.label_width,
+                l.left_link,
+                l.left_width);
+    }
+    template<typename Writer>
+    void Render::writeMessageElement(const Layout &l, Writer &w) const {
+        writeTextElement(
+                l,
+                w,
+                l.message_margin,
+                l.badge.message_,
+                l.message_color,
+                l.message_width,
+                l.right_link,
+                l.right_width);
+    }
+
+
+    template<typename F>
+    decltype(auto) Render::visit(Style style, F &&f) {
+        switch (style) {
                 // clang-format off
-            case FLAT:         return std::make_unique<FlatRender>(badge);
-            case FLAT_SQUARE:  return std::make_unique<FlatSquareRender>(badge);
-            case PLASTIC:      return std::make_unique<PlasticRender>(badge);
-            case FOR_THE_BADGE:return std::make_unique<ForTheBadgeRender>(badge);
-            case SOCIAL:       return std::make_unique<SocialRender>(badge);
+            case FLAT:         return f(instance<FlatRender>());
+            case FLAT_SQUARE:  return f(instance<FlatSquareRender>());
+            case PLASTIC:      return f(instance<PlasticRender>());
+            case FOR_THE_BADGE:return f(instance<ForTheBadgeRender>());
+            case SOCIAL:       return f(instance<SocialRender>());
                 // clang-format on
-            default:
-                break;
         }
-        throw std::runtime_error("[badgecpp::Render::create] Unsupported style: " + std::to_string(badge.style_));
+        throw std::runtime_error("[badgecpp::Render::visit] Unsupported style: " + std::to_string(style));
+    }
+    const Render &Render::get(Style style) {
+        return visit(style, [](const Render &render) -> const Render & { return render; });
+    }
+    std::unique_ptr<BoundRender> Render::create(const Badge &badge) {
+        return std::make_unique<BoundRender>(get(badge.style_), badge);
+    }
+    BoundRender::BoundRender(const Render &render, const Badge &badge) : render_(render), layout_(render.layout(badge.view())) {
+    }
+    Xml BoundRender::render() const {
+        return render_.render(layout_);
+    }
+    void BoundRender::render(std::string &out) const {
+        render_.render(layout_, out);
+    }
+    pmr::Xml BoundRender::render(std::pmr::memory_resource *resource) const {
+        return render_.render(layout_, resource);
+    }
+    void Render::render(const BadgeView &badge, std::string &out) {
+        visit(badge.style_, [&](const auto &render) {
+            BADGECPP_METRICS_RENDER();
+            renderStream(render, timedLayout(render, badge), out);
+        });
+    }
+    Xml Render::renderXml(const BadgeView &badge) {
+        return visit(badge.style_, [&](const auto &render) {
+            BADGECPP_METRICS_RENDER();
+            return renderTree(render, timedLayout(render, badge));
+        });
+    }
+    pmr::Xml Render::renderXml(const BadgeView &badge, std::pmr::memory_resource *resource) {
+        return visit(badge.style_, [&](const auto &render) {
+            BADGECPP_METRICS_RENDER();
+            return renderTree(render, timedLayout(render, badge), resource);
+        });
     }
 
 
@@ -278,133 +350,31 @@ namespace badge {
 
 
 namespace badge {
-    unsigned int FlatSquareRender::get_height() const {
-        return 20;
-    }
-    unsigned int FlatSquareRender::get_vertical_margin() const {
-        return 0;
-    }
-    bool FlatSquareRender::text_has_shadow() const {
-        return false;
-    }
-    Xml FlatSquareRender::get_content() const {
-        return {
-                "",
-                getBackgroundGroupElement(
-                        false, {
-                                       {"shape-rendering", "crispEdges"},
-                               }),
-                getForegroundGroupElement(),
-        };
+    template<typename Writer>
+    void FlatSquareRender::emit_content(const Layout &l, Writer &w) const {
+        writeBackgroundGroupElement(l, w, false, crispEdgesGroup());
+        writeForegroundGroupElement(l, w);
     }
 }// namespace badge
 
 namespace badge {
-    unsigned int FlatRender::get_height() const {
-        return 20;
-    }
-    unsigned int FlatRender::get_vertical_margin() const {
-        return 0;
-    }
-    bool FlatRender::text_has_shadow() const {
-        return true;
-    }
-    Xml FlatRender::get_content() const {
-        return {
-                "",
-                Xml{
-                        "linearGradient",
-                        {
-                                {"id", "s" + idSuffix},
-                                {"x2", "0"},
-                                {"y2", "100%"},
-                        },
-                        Xml{
-                                "stop",
-                                {
-                                        {"offset", "0"},
-                                        {"stop-color", "#bbb"},
-                                        {"stop-opacity", ".1"},
-                                },
-                        },
-                        Xml{
-                                "stop",
-                                {
-                                        {"offset", "1"},
-                                        {"stop-opacity", ".1"},
-                                },
-                        },
-                },
-                getClipPathElement(3),
-                getBackgroundGroupElement(
-                        true,
-                        {{"clip-path", "url(#r" + idSuffix + ")"}}),
-                getForegroundGroupElement(),
-        };
+    template<typename Writer>
+    void FlatRender::emit_content(const Layout &l, Writer &w) const {
+        w.fill(flatGradient(), {l.idSuffix});
+        writeClipPathElement(l, w, 3);
+        writeBackgroundGroupElement(l, w, true, clipPathGroup());
+        writeForegroundGroupElement(l, w);
     }
 }// namespace badge
 
 
 namespace badge {
-    unsigned int PlasticRender::get_height() const {
-        return 18;
-    }
-    unsigned int PlasticRender::get_vertical_margin() const {
-        return -10;
-    }
-    bool PlasticRender::text_has_shadow() const {
-        return true;
-    }
-    Xml PlasticRender::get_content() const {
-        return {
-                "",
-                Xml{
-                        "linearGradient",
-                        {
-                                {"id", 's' + idSuffix},
-                                {"x2", "0"},
-                                {"y2", "100%"},
-                        },
-                        Xml{
-                                "stop",
-                                {
-                                        {"offset", "0"},
-                                        {"stop-color", "#fff"},
-                                        {"stop-opacity", ".7"},
-                                },
-                        },
-                        Xml{
-                                "stop",
-                                {
-                                        {"offset", ".1"},
-                                        {"stop-color", "#aaa"},
-                                        {"stop-opacity", ".1"},
-                                },
-                        },
-                        Xml{
-                                "stop",
-                                {
-                                        {"offset", ".9"},
-                                        {"stop-color", "#000"},
-                                        {"stop-opacity", ".3"},
-                                },
-                        },
-                        Xml{
-                                "stop",
-                                {
-                                        {"offset", "1"},
-                                        {"stop-color", "#000"},
-                                        {"stop-opacity", ".5"},
-                                },
-                        },
-                },
-                getClipPathElement(4),
-                getBackgroundGroupElement(
-                        true, {
-                                      {"clip-path", "url(#r" + idSuffix + ')'},
-                              }),
-                getForegroundGroupElement(),
-        };
+    template<typename Writer>
+    void PlasticRender::emit_content(const Layout &l, Writer &w) const {
+        w.fill(plasticGradient(), {l.idSuffix});
+        writeClipPathElement(l, w, 4);
+        writeBackgroundGroupElement(l, w, true, clipPathGroup());
+        writeForegroundGroupElement(l, w);
     }
 }// namespace badge
 
@@ -412,501 +382,280 @@ namespace badge {
 namespace {
     using namespace badge;
 
-    constexpr unsigned int socialExternalHeigth = 20;
+    constexpr unsigned int socialExternalHeigth = badge::SocialRender::TRAITS.height;
     constexpr unsigned int socialInternalHeight = 19;
     constexpr unsigned int socialLabelHorizPadding = 5;
     constexpr unsigned int socialMessageHorizPadding = 4;
     constexpr unsigned int socialHorizGutter = 6;
 
-    const std::string SOCIAL_FONT_FAMILY = "Helvetica Neue,Helvetica,Arial,sans-serif";
-    const Font &SOCIAL_FONT = *Fonts::get("helvetica-11px-bold");
-}// namespace
+    constexpr std::string_view SOCIAL_FONT_FAMILY = "Helvetica Neue,Helvetica,Arial,sans-serif";
+    const Font &socialFont() {
+        static const Font &font = *Fonts::get("helvetica-11px-bold");
+        return font;
+    }
 
-namespace badge {
-    unsigned int SocialRender::get_height() const {
-        return socialExternalHeigth;
+    const XmlTemplate &socialHead() {
+        static const XmlTemplate t{R"svg(<style>a:hover #llink$0{fill:url(#b$0);stroke:#ccc}a:hover #rlink$0{fill:#4183c4}</style>)svg"
+                                   R"svg(<linearGradient id="a$0" x2="0" y2="100%"><stop offset="0" stop-color="#fcfcfc" stop-opacity="0"/><stop offset="1" stop-opacity=".1"/></linearGradient>)svg"
+                                   R"svg(<linearGradient id="b$0" x2="0" y2="100%"><stop offset="0" stop-color="#ccc" stop-opacity=".1"/><stop offset="1" stop-opacity=".1"/></linearGradient>)svg"
+                                   R"svg(<g stroke="#d5d5d5"><rect x="0.5" y="0.5" width="$1" height="$2" rx="2" stroke="none" fill="#fcfcfc"/>)svg"};
+        return t;
     }
-    unsigned int SocialRender::get_vertical_margin() const {
-        throw std::logic_error("[badgecpp::SocialRender::get_vertical_margin] Not implemented");
+    const XmlTemplate &socialLabelLink() {
+        static const XmlTemplate t{R"svg(<rect id="llink$0" stroke="#d5d5d5" fill="url(#a$0)" x=".5" y=".5" width="$1" height="$2" rx="2"/></g>)svg"};
+        return t;
     }
-    bool SocialRender::text_has_shadow() const {
-        throw std::logic_error("[badgecpp::SocialRender::text_has_shadow] Not implemented");
+    const XmlTemplate &socialForegroundGroup() {
+        static const XmlTemplate t{R"svg(<g aria-hidden="$0" fill="#333" text-anchor="middle" font-family="$1" text-rendering="geometricPrecision" font-weight="700" font-size="110px" line-height="14px")svg"};
+        return t;
     }
-    unsigned int SocialRender::get_str_width(const std::optional<std::string> &str, [[maybe_unused]] TextType tt) const {
+    const XmlTemplate &socialMessageBubble() {
+        static const XmlTemplate t{R"svg(<rect x="$0" y="0.5" width="$1" height="$2" rx="2" fill="#fafafa"/>)svg"
+                                   R"svg(<rect x="$3" y="7.5" width="0.5" height="5" stroke="#fafafa"/>)svg"
+                                   R"svg(<path d="M$0 6.5 l-3 3v1 l3 3" fill="#fafafa" stroke="d5d5d5"/>)svg"};
+        return t;
+    }
+    const XmlTemplate &socialShadowText() {
+        static const XmlTemplate t{R"svg(<text aria-hidden="true" x="$0" y="150" fill="#fff" transform="$1" textLength="$2")svg"};
+        return t;
+    }
+    const XmlTemplate &socialLabelText() {
+        static const XmlTemplate t{R"svg(<text x="$0" y="140" transform="$1" textLength="$2")svg"};
+        return t;
+    }
+    const XmlTemplate &socialMessageText() {
+        static const XmlTemplate t{R"svg(<text id="rlink$3" x="$0" y="140" transform="$1" textLength="$2")svg"};
+        return t;
+    }
+}// namespace
+
+namespace badge {
+    unsigned int SocialRender::get_str_width([[maybe_unused]] const Layout &l, const std::optional<std::string_view> &str, [[maybe_unused]] TextType tt) const {
         if (!str) return 0;
-        auto width = static_cast<unsigned int>(SOCIAL_FONT.widthOfString(*str));
+        auto width = static_cast<unsigned int>(socialFont().widthOfString(*str));
         return width % 2 ? width : (width + 1);
     }
-    Xml SocialRender::render() {
-        calcValues();
-
-        label_rect_width =
-                hasLogo && hasLabel ? socialLabelHorizPadding + logo_width + LOGO_LABEL_PADDING + label_width + socialLabelHorizPadding
-                : hasLabel          ? socialLabelHorizPadding + label_width + socialLabelHorizPadding
-                : hasLogo           ? socialLabelHorizPadding + logo_width + socialLabelHorizPadding
-                                    : 0;
-        left_width = label_rect_width + 1;
-        message_rect_width = socialMessageHorizPadding + message_width + socialMessageHorizPadding;
-        right_width = hasMessage ? socialHorizGutter + message_rect_width : 0;
-
-        width = left_width + right_width > 0 ? left_width + right_width : height;
-
-        return Render::renderSvg();
-    }
-    Xml SocialRender::get_content() const {
-        std::string style_str = "a:hover #llink";
-        style_str += idSuffix;
-        style_str += "{fill:url(#b";
-        style_str += idSuffix;
-        style_str += ");stroke:#ccc}a:hover #rlink";
-        style_str += idSuffix;
-        style_str += "{fill:#4183c4}";
-        Xml style{"style", style_str};
-
-        Xml gradients{
-                "",
-                Xml{
-                        "linearGradient",
-                        {
-                                {"id", "a" + idSuffix},
-                                {"x2", "0"},
-                                {"y2", "100%"},
-                        },
-                        Xml{
-                                "stop",
-                                {
-                                        {"offset", "0"},
-                                        {"stop-color", "#fcfcfc"},
-                                        {"stop-opacity", "0"},
-                                },
-                        },
-                        Xml{
-                                "stop",
-                                {
-                                        {"offset", "1"},
-                                        {"stop-opacity", ".1"},
-                                },
-                        },
-                },
-                Xml{
-                        "linearGradient",
-                        {
-                                {"id", "b" + idSuffix},
-                                {"x2", "0"},
-                                {"y2", "100%"},
-                        },
-                        Xml{
-                                "stop",
-                                {
-                                        {"offset", "0"},
-                                        {"stop-color", "#ccc"},
-                                        {"stop-opacity", ".1"},
-                                },
-                        },
-                        Xml{
-                                "stop",
-                                {
-                                        {"offset", "1"},
-                                        {"stop-opacity", ".1"},
-                                },
-                        },
-                },
-        };
-        Xml labelRect1{
-                "rect",
-                {
-                        {"x", "0.5"},
-                        {"y", "0.5"},
-                        {"width", std::to_string(label_rect_width)},
-                        {"height", std::to_string(socialInternalHeight)},
-                        {"rx", "2"},
-                        {"stroke", "none"},
-                        {"fill", "#fcfcfc"},
-                },
-        };
-        Xml labelRect2{
-                "rect",
-                {
-                        {"id", "llink" + idSuffix},
-                        {"stroke", "#d5d5d5"},
-                        {"fill", "url(#a" + idSuffix + ")"},
-                        {"x", ".5"},
-                        {"y", ".5"},
-                        {"width", std::to_string(label_rect_width)},
-                        {"height", std::to_string(socialInternalHeight)},
-                        {"rx", "2"},
-                },
-        };
-        Xml backgroundGroup{
-                "g",
-                {{"stroke", "#d5d5d5"}},
-                std::move(labelRect1),
-                getMessageBubble(),
-                std::move(labelRect2),
-        };
-        Xml foregroundGroup{
-                "g",
-                {
-                        {"aria-hidden", body_link ? "true" : "false"},
-                        {"fill", "#333"},
-                        {"text-anchor", "middle"},
-                        {"font-family", SOCIAL_FONT_FAMILY},
-                        {"text-rendering", "geometricPrecision"},
-                        {"font-weight", "700"},
-                        {"font-size", "110px"},
-                        {"line-height", "14px"},
-                },
-                getLabelText(),
-                getMessageText(),
-        };
-        return {
-                "",
-                std::move(style),
-                std::move(gradients),
-                std::move(backgroundGroup),
-                getLogoElement(socialLabelHorizPadding, height),
-                std::move(foregroundGroup),
-        };
-    }
-
-    Xml SocialRender::getMessageBubble() const {
-        if (!hasMessage) return {};
-        const auto messageBubbleNotchX = label_rect_width + socialHorizGutter;
-        const auto messageBubbleMainX = messageBubbleNotchX + 0.5;
-        return {
-                "",
-                Xml{
-                        "rect",
-                        {
-                                {"x", std::to_string(messageBubbleMainX)},
-                                {"y", "0.5"},
-                                {"width", std::to_string(message_rect_width)},
-                                {"height", std::to_string(socialInternalHeight)},
-                                {"rx", "2"},
-                                {"fill", "#fafafa"},
-                        },
-                },
-                Xml{
-                        "rect",
-                        {
-                                {"x", std::to_string(messageBubbleNotchX)},
-                                {"y", "7.5"},
-                                {"width", "0.5"},
-                                {"height", "5"},
-                                {"stroke", "#fafafa"},
-                        },
-                },
-                Xml{
-                        "path",
-                        {
-                                {"d", "M" + std::to_string(messageBubbleMainX) + " 6.5 l-3 3v1 l3 3"},
-                                {"fill", "#fafafa"},
-                                {"stroke", "d5d5d5"},
-                        },
-                },
-        };
-    }
-    Xml SocialRender::getLabelText() const {
-        if (!badge.label_) return {};
-
-        const auto labelTextX = dtos(FONT_SIZE_UP * (hasLogo
-                                                             ? logo_width + LOGO_LABEL_PADDING + label_width / 2.0 + socialLabelHorizPadding
-                                                             : label_width / 2.0 + socialLabelHorizPadding));
-        const auto labelTextLength = FONT_SIZE_UP * label_width;
-        const auto shouldWarpLink = left_link && !body_link;
-
-        Xml shadow{
-                "text",
-                {
-                        {"aria-hidden", "true"},
-                        {"x", labelTextX},
-                        {"y", "150"},
-                        {"fill", "#fff"},
-                        {"transform", FONT_SIZE_DOWN},
-                        {"textLength", std::to_string(labelTextLength)},
-                },
-                *badge.label_,
-        };
-        Xml text{
-                "text",
-                {
-                        {"x", labelTextX},
-                        {"y", "140"},
-                        {"transform", FONT_SIZE_DOWN},
-                        {"textLength", std::to_string(labelTextLength)},
-                },
-                *badge.label_,
-        };
-        if (shouldWarpLink) {
-            return Xml{
-                    "a",
-                    {{"target", "_blank"}, {"xlink:href", *left_link}},
-                    std::move(shadow),
-                    std::move(text),
-            };
-        } else {
-            return Xml{
-                    "",
-                    std::move(shadow),
-                    std::move(text),
-            };
-        }
+    void SocialRender::calcValues(Layout &l) const {
+        calcLayout(*this, l);
+
+        l.label_rect_width =
+                l.hasLogo && l.hasLabel ? socialLabelHorizPadding + l.logo_width + LOGO_LABEL_PADDING + l.label_width + socialLabelHorizPadding
+                : l.hasLabel            ? socialLabelHorizPadding + l.label_width + socialLabelHorizPadding
+                : l.hasLogo             ? socialLabelHorizPadding + l.logo_width + socialLabelHorizPadding
+                                        : 0;
+        l.left_width = l.label_rect_width + 1;
+        l.message_rect_width = socialMessageHorizPadding + l.message_width + socialMessageHorizPadding;
+        l.right_width = l.hasMessage ? socialHorizGutter + l.message_rect_width : 0;
+
+        l.width = l.left_width + l.right_width > 0 ? l.left_width + l.right_width : l.height;
     }
-    Xml SocialRender::getMessageText() const {
-        if (!hasMessage) return {};
-        const auto messageTextX = dtos(FONT_SIZE_UP * (label_rect_width + socialHorizGutter + message_rect_width / 2.0));
-        const auto messageTextLength = FONT_SIZE_UP * message_width;
-
-
-        Xml shadow{
-                "text",
-                {
-                        {"aria-hidden", "true"},
-                        {"x", messageTextX},
-                        {"y", "150"},
-                        {"fill", "#fff"},
-                        {"transform", FONT_SIZE_DOWN},
-                        {"textLength", std::to_string(messageTextLength)},
-                },
-                *badge.message_,
-        };
-        Xml text{
-                "text",
-                {
-                        {"id", "rlink" + idSuffix},
-                        {"x", messageTextX},
-                        {"y", "140"},
-                        {"transform", FONT_SIZE_DOWN},
-                        {"textLength", std::to_string(messageTextLength)},
-                },
-                *badge.message_,
-        };
-
-        if (right_link) {
-            Xml rect{
-                    "rect",
-                    {
-                            {"width", std::to_string(message_rect_width + 1)},
-                            {"x", std::to_string(label_rect_width + socialHorizGutter)},
-                            {"height", std::to_string(socialInternalHeight + 1)},
-                            {"fill", "rgba(0,0,0,0)"},
-                    },
-            };
-            return Xml{
-                    "a",
-                    {{"target", "_blank"}, {"xlink:href", *right_link}},
-                    std::move(rect),
-                    std::move(shadow),
-                    std::move(text),
-            };
-        } else {
-            return Xml{
-                    "",
-                    std::move(shadow),
-                    std::move(text),
-            };
+    template<typename Writer>
+    void SocialRender::emit_content(const Layout &l, Writer &w) const {
+        // style, gradients, background group
+        w.fill(socialHead(), {l.idSuffix, l.label_rect_width, socialInternalHeight});
+        writeMessageBubble(l, w);
+        w.fill(socialLabelLink(), {l.idSuffix, l.label_rect_width, socialInternalHeight});
+
+        writeLogoElement(l, w, socialLabelHorizPadding, l.height);
+
+        // foreground group
+        w.fill(socialForegroundGroup(), {l.body_link ? "true" : "false", SOCIAL_FONT_FAMILY});
+        writeLabelText(l, w);
+        writeMessageText(l, w);
+        w.close("g");
+    }
+
+    template<typename Writer>
+    void SocialRender::writeMessageBubble(const Layout &l, Writer &w) const {
+        if (!l.hasMessage) return;
+        const auto messageBubbleNotchX = l.label_rect_width + socialHorizGutter;
+        const auto messageBubbleMainX = messageBubbleNotchX + 0.5;
+        const auto mainX = NumberString::trimmed(messageBubbleMainX);
+        w.fill(socialMessageBubble(), {mainX, l.message_rect_width, socialInternalHeight, messageBubbleNotchX});
+    }
+    template<typename Writer>
+    void SocialRender::writeLabelText(const Layout &l, Writer &w) const {
+        if (!l.badge.label_) return;
+
+        const auto labelTextX = NumberString::trimmed(FONT_SIZE_UP * (l.hasLogo
+                                                               ? l.logo_width + LOGO_LABEL_PADDING + l.label_width / 2.0 + socialLabelHorizPadding
+                                                               : l.label_width / 2.0 + socialLabelHorizPadding));
+        const auto labelTextLength = FONT_SIZE_UP * l.label_width;
+        const auto shouldWarpLink = l.left_link && !l.body_link;
+
+        if (shouldWarpLink) w.open("a").attr("target", "_blank").attr("xlink:href", *l.left_link);
+        w.fill(socialShadowText(), {labelTextX, FONT_SIZE_DOWN, labelTextLength}).text(*l.badge.label_).close("text");
+        w.fill(socialLabelText(), {labelTextX, FONT_SIZE_DOWN, labelTextLength}).text(*l.badge.label_).close("text");
+        if (shouldWarpLink) w.close("a");
+    }
+    template<typename Writer>
+    void SocialRender::writeMessageText(const Layout &l, Writer &w) const {
+        if (!l.hasMessage) return;
+        const auto messageTextX = NumberString::trimmed(FONT_SIZE_UP * (l.label_rect_width + socialHorizGutter + l.message_rect_width / 2.0));
+        const auto messageTextLength = FONT_SIZE_UP * l.message_width;
+
+        if (l.right_link) {
+            w.open("a").attr("target", "_blank").attr("xlink:href", *l.right_link);
+            w.open("rect")
+                    .attr("width", NumberString(l.message_rect_width + 1))
+                    .attr("x", NumberString(l.label_rect_width + socialHorizGutter))
+                    .attr("height", NumberString(socialInternalHeight + 1))
+                    .attr("fill", "rgba(0,0,0,0)")
+                    .close("rect");
         }
+        w.fill(socialShadowText(), {messageTextX, FONT_SIZE_DOWN, messageTextLength}).text(*l.badge.message_).close("text");
+        w.fill(socialMessageText(), {messageTextX, FONT_SIZE_DOWN, messageTextLength, l.idSuffix}).text(*l.badge.message_).close("text");
+        if (l.right_link) w.close("a");
     }
 }// namespace badge
 
 
 namespace {
     constexpr unsigned int ftbFontSize = 10;
-    constexpr unsigned int ftbBadgeHeight = 28;
+    constexpr unsigned int ftbBadgeHeight = badge::ForTheBadgeRender::TRAITS.height;
     constexpr unsigned int ftbTextMargin = 12;
     constexpr unsigned int ftbLogoMargin = 9;
     constexpr unsigned int ftbLogoTextGutter = 6;
     constexpr double ftbLetterSpacing = 1.25;
 
-    const Font &ftbLabelFont = *Fonts::get("verdana-10px-normal");
-    const Font &ftbMessageFont = *Fonts::get("verdana-10px-bold");
-}// namespace
-
-namespace badge {
+    const Font &ftbLabelFont() {
+        static const Font &font = *Fonts::get("verdana-10px-normal");
+        return font;
+    }
+    const Font &ftbMessageFont() {
+        static const Font &font = *Fonts::get("verdana-10px-bold");
+        return font;
+    }
 
-    [[nodiscard]] unsigned int ForTheBadgeRender::get_height() const {
-        return ftbBadgeHeight;
+    const XmlTemplate &ftbRect() {
+        static const XmlTemplate t{R"svg(<rect width="$0" height="$1" fill="$2"/>)svg"};
+        return t;
     }
-    [[nodiscard]] unsigned int ForTheBadgeRender::get_vertical_margin() const {
-        throw std::logic_error("[badgecpp::ForTheBadgeRender::get_vertical_margin] Not implemented");
+    const XmlTemplate &ftbRightRect() {
+        static const XmlTemplate t{R"svg(<rect x="$0" width="$1" height="$2" fill="$3"/>)svg"};
+        return t;
     }
-    [[nodiscard]] bool ForTheBadgeRender::text_has_shadow() const {
-        throw std::logic_error("[badgecpp::ForTheBadgeRender::text_has_shadow] Not implemented");
+    const XmlTemplate &ftbForegroundGroup() {
+        static const XmlTemplate t{R"svg(<g fill="#fff" text-anchor="middle" font-family="$0" text-rendering="geometricPrecision" font-size="$1")svg"};
+        return t;
     }
+    const XmlTemplate &ftbLabelText() {
+        static const XmlTemplate t{R"svg(<text transform="$0" x="$1" y="175" textLength="$2" fill="$3")svg"};
+        return t;
+    }
+    const XmlTemplate &ftbMessageText() {
+        static const XmlTemplate t{R"svg(<text transform="$0" x="$1" y="175" textLength="$2" fill="$3" font-weight="bold")svg"};
+        return t;
+    }
+}// namespace
 
-    unsigned int ForTheBadgeRender::get_str_width(const std::optional<std::string> &str, TextType tt) const {
+namespace badge {
+
+    unsigned int ForTheBadgeRender::get_str_width(const Layout &l, const std::optional<std::string_view> &str, TextType tt) const {
         if (!str) return 0;
 
         switch (tt) {
             case Render::TextType::LABEL: {
-                auto u32str = Font::toU32String(up_label);
-                return ftbLabelFont.widthOfString(u32str) + ftbLetterSpacing * u32str.length();
+                size_t length;
+                const double width = ftbLabelFont().widthOfString(l.up_label, true, length);
+                return width + ftbLetterSpacing * length;
             }
             case Render::TextType::MESSAGE: {
-                auto u32str = Font::toU32String(up_message);
-                return ftbMessageFont.widthOfString(u32str) + ftbLetterSpacing * u32str.length();
+                size_t length;
+                const double width = ftbMessageFont().widthOfString(l.up_message, true, length);
+                return width + ftbLetterSpacing * length;
             }
         }
         throw std::logic_error("[badgecpp::ForTheBadgeRender::get_str_width] Unsupported text type");
     }
-    Xml ForTheBadgeRender::render() {
+    void ForTheBadgeRender::calcValues(Layout &l) const {
 
-        if (badge.label_) up_label = toUpperCase(*badge.label_);
-        if (badge.message_) up_message = toUpperCase(*badge.message_);
+        if (l.badge.label_) l.up_label = toUpperCase(std::string{*l.badge.label_});
+        if (l.badge.message_) l.up_message = toUpperCase(std::string{*l.badge.message_});
 
-        calcValues();
+        calcLayout(*this, l);
 
 
-        label_text_min_x = hasLogo ? ftbLogoMargin + logo_width + ftbLogoTextGutter
-                                   : ftbTextMargin;
+        l.label_text_min_x = l.hasLogo ? ftbLogoMargin + l.logo_width + ftbLogoTextGutter
+                                       : ftbTextMargin;
 
-        if (hasLabel || hasLogo) {
-            label_rect_width = hasLabel ? label_text_min_x + label_width + ftbTextMargin
-                                        : ftbLogoMargin + logo_width + ftbLogoMargin;
-            message_text_min_x = label_rect_width + ftbTextMargin;
-            message_rect_width = hasMessage ? ftbTextMargin + message_width + ftbTextMargin : 0;
-        } else if (hasLogo) {
-            label_rect_width = 0;
-            message_text_min_x = ftbTextMargin + logo_width + ftbLogoTextGutter;
-            message_rect_width = hasMessage ? ftbTextMargin + logo_width + ftbLogoTextGutter + message_width + ftbTextMargin : 0;
+        if (l.hasLabel || l.hasLogo) {
+            l.label_rect_width = l.hasLabel ? l.label_text_min_x + l.label_width + ftbTextMargin
+                                            : ftbLogoMargin + l.logo_width + ftbLogoMargin;
+            l.message_text_min_x = l.label_rect_width + ftbTextMargin;
+            l.message_rect_width = l.hasMessage ? ftbTextMargin + l.message_width + ftbTextMargin : 0;
+        } else if (l.hasLogo) {
+            l.label_rect_width = 0;
+            l.message_text_min_x = ftbTextMargin + l.logo_width + ftbLogoTextGutter;
+            l.message_rect_width = l.hasMessage ? ftbTextMargin + l.logo_width + ftbLogoTextGutter + l.message_width + ftbTextMargin : 0;
         } else {
-            label_rect_width = 0;
-            message_text_min_x = ftbTextMargin;
-            message_rect_width = hasMessage ? ftbTextMargin + message_width + ftbTextMargin : 0;
+            l.label_rect_width = 0;
+            l.message_text_min_x = ftbTextMargin;
+            l.message_rect_width = l.hasMessage ? ftbTextMargin + l.message_width + ftbTextMargin : 0;
         }
 
-        width = label_rect_width + message_rect_width;
-
-        return Render::renderSvg();
+        l.width = l.label_rect_width + l.message_rect_width;
     }
 
 
-    Xml ForTheBadgeRender::get_content() const {
-
-        Xml foregroundGroup{
-                "g",
-                {
-                        {"fill", "#fff"},
-                        {"text-anchor", "middle"},
-                        {"font-family", FONT_FAMILY},
-                        {"text-rendering", "geometricPrecision"},
-                        {"font-size", std::to_string(FONT_SIZE_UP * ftbFontSize)},
-                },
-        };
-        if (hasLogo) foregroundGroup.addContent(getLogoElement(ftbLogoMargin, ftbBadgeHeight));
-        if (hasLabel) foregroundGroup.addContent(getLabelElement());
-        if (hasMessage) foregroundGroup.addContent(getMessageElement());
-        Xml backgroundGroup{
-                "g",
-                {{"shape-rendering", "crispEdges"}},
-        };
-        if (hasLabel || hasLogo) {
+    template<typename Writer>
+    void ForTheBadgeRender::emit_content(const Layout &l, Writer &w) const {
+        w.open("g").attr("shape-rendering", "crispEdges");
+        if (l.hasLabel || l.hasLogo) {
             // label background
-            backgroundGroup.addContent(Xml{
-                    "rect",
-                    {
-                            {"width", std::to_string(label_rect_width)},
-                            {"height", std::to_string(ftbBadgeHeight)},
-                            {"fill", badge.label_color_ ? badge.label_color_->to_str() : DEFAULT_LABEL_COLOR},
-                    },
-            });
+            w.fill(ftbRect(), {l.label_rect_width, ftbBadgeHeight, l.label_color.str()});
             // message background
-            if (hasMessage) {
-                backgroundGroup.addContent(Xml{
-                        "rect",
-                        {
-                                {"x", std::to_string(label_rect_width)},
-                                {"width", std::to_string(message_rect_width)},
-                                {"height", std::to_string(ftbBadgeHeight)},
-                                {"fill", badge.message_color_ ? badge.message_color_->to_str() : DEFAULT_MESSAGE_COLOR},
-                        },
-                });
-            }
-        } else if (hasMessage) {
+            if (l.hasMessage) w.fill(ftbRightRect(), {l.label_rect_width, l.message_rect_width, ftbBadgeHeight, l.message_color.str()});
+        } else if (l.hasMessage) {
             // message background
-            backgroundGroup.addContent(Xml{
-                    "rect",
-                    {
-                            {"width", std::to_string(message_rect_width)},
-                            {"height", std::to_string(ftbBadgeHeight)},
-                            {"fill", badge.message_color_ ? badge.message_color_->to_str() : DEFAULT_MESSAGE_COLOR},
-                    },
-            });
-        }
-        return {
-                "",
-                std::move(backgroundGroup),
-                std::move(foregroundGroup),
-        };
-    }
-
-    Xml ForTheBadgeRender::getLabelElement() const {
-        const auto textColor = Color(badge.label_color_ ? badge.label_color_->to_str() : DEFAULT_LABEL_COLOR).getColorHexPairForBackground().first;
-        const auto midX = label_text_min_x + 0.5 * label_width;
-
-        Xml text{
-                "text",
-                {
-                        {"transform", FONT_SIZE_DOWN},
-                        {"x", dtos(FONT_SIZE_UP * midX)},
-                        {"y", "175"},
-                        {"textLength", dtos(FONT_SIZE_UP * label_width)},
-                        {"fill", textColor},
-                },
-                up_label,
-        };
-        if (left_link) {
-            return {
-                    "a",
-                    {{"target", "_blank"}, {"xlink:href", *left_link}},
-                    Xml{
-                            "rect",
-                            {
-                                    {"width", std::to_string(label_rect_width)},
-                                    {"height", std::to_string(ftbBadgeHeight)},
-                                    {"fill", "rgba(0,0,0,0)"},
-                            },
-                    },
-                    std::move(text),
-            };
-        } else {
-            return text;
+            w.fill(ftbRect(), {l.message_rect_width, ftbBadgeHeight, l.message_color.str()});
         }
+        w.close("g");
+
+        w.fill(ftbForegroundGroup(), {FONT_FAMILY, FONT_SIZE_UP * ftbFontSize});
+        if (l.hasLogo) writeLogoElement(l, w, ftbLogoMargin, ftbBadgeHeight);
+        if (l.hasLabel) writeLabelElement(l, w);
+        if (l.hasMessage) writeMessageElement(l, w);
+        w.close("g");
     }
-    Xml ForTheBadgeRender::getMessageElement() const {
-        const auto textColor = Color(badge.message_color_ ? badge.message_color_->to_str() : DEFAULT_MESSAGE_COLOR).getColorHexPairForBackground().first;
-        const auto midX = message_text_min_x + 0.5 * message_width;
-
-        Xml text{
-                "text",
-                {
-                        {"transform", FONT_SIZE_DOWN},
-                        {"x", dtos(FONT_SIZE_UP * midX)},
-                        {"y", "175"},
-                        {"textLength", dtos(FONT_SIZE_UP * message_width)},
-                        {"fill", textColor},
-                        {"font-weight", "bold"},
-                },
-                up_message,
-        };
-        if (right_link) {
-            return {
-                    "a",
-                    {{"target", "_blank"}, {"xlink:href", *right_link}},
-                    Xml{
-                            "rect",
-                            {
-                                    {"width", std::to_string(message_rect_width)},
-                                    {"height", std::to_string(ftbBadgeHeight)},
-                                    {"x", std::to_string(label_rect_width)},
-                                    {"fill", "rgba(0,0,0,0)"},
-                            },
-                    },
-                    std::move(text),
-            };
-        } else {
-            return text;
+
+
+    template<typename Writer>
+    void ForTheBadgeRender::writeLabelElement(const Layout &l, Writer &w) const {
+        const auto textColor = l.label_color.text;
+        const auto midX = l.label_text_min_x + 0.5 * l.label_width;
+
+        if (l.left_link) {
+            w.open("a").attr("target", "_blank").attr("xlink:href", *l.left_link);
+            w.open("rect")
+                    .attr("width", NumberString(l.label_rect_width))
+                    .attr("height", NumberString(ftbBadgeHeight))
+                    .attr("fill", "rgba(0,0,0,0)")
+                    .close("rect");
+        }
+        const auto x = NumberString::trimmed(FONT_SIZE_UP * midX);
+        const auto textLength = NumberString::trimmed(FONT_SIZE_UP * l.label_width);
+        w.fill(ftbLabelText(), {FONT_SIZE_DOWN, x, textLength, textColor}).text(l.up_label).close("text");
+        if (l.left_link) w.close("a");
+    }
+    template<typename Writer>
+    void ForTheBadgeRender::writeMessageElement(const Layout &l, Writer &w) const {
+        const auto textColor = l.message_color.text;
+        const auto midX = l.message_text_min_x + 0.5 * l.message_width;
+
+        if (l.right_link) {
+            w.open("a").attr("target", "_blank").attr("xlink:href", *l.right_link);
+            w.open("rect")
+                    .attr("width", NumberString(l.message_rect_width))
+                    .attr("height", NumberString(ftbBadgeHeight))
+                    .attr("x", NumberString(l.label_rect_width))
+                    .attr("fill", "rgba(0,0,0,0)")
+                    .close("rect");
         }
+        const auto x = NumberString::trimmed(FONT_SIZE_UP * midX);
+        const auto textLength = NumberString::trimmed(FONT_SIZE_UP * l.message_width);
+        w.fill(ftbMessageText(), {FONT_SIZE_DOWN, x, textLength, textColor}).text(l.up_message).close("text");
+        if (l.right_link) w.close("a");
     }
 
 }// namespace badge
\ No newline at end of file
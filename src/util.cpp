@@ -1,72 +1,79 @@
 #include "badgecpp/util.hpp"
 #include <algorithm>
-namespace badge {
-    std::string dtos(double num, int p) {
-        // 处理负数
-        bool negative = false;
-        if (num < 0) {
-            negative = true;
-            num = -num;
-        }
-
-        // 分离整数部分
-        long long integer_part = static_cast<long long>(num);
-
-        // 分离小数部分
-        double decimal_part_f = num - static_cast<double>(integer_part);
+#include <cmath>
+namespace {
+    constexpr double POW10[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17};
+    /// @brief 放大后的值小于此数时, double 的精度足以区分相邻的 p 位小数
+    constexpr double SCALED_LIMIT = 0x1p51;
 
-        // 将小数部分转换为整数，避免浮点精度问题
-        long long decimal_part = 0;
-        if (p > 0) {
-            double multiplier = 1.0;
-            for (int i = 0; i < p; ++i) multiplier *= 10.0;
-            decimal_part = static_cast<long long>(decimal_part_f * multiplier);
+    /// @brief 将 value / 10^p 写入 out, 去掉小数部分末尾的0
+    char *write_scaled(long long value, int p, char *out) {
+        if (value < 0) *out++ = '-';
+        auto digits = value < 0 ? 0ull - static_cast<unsigned long long>(value) : static_cast<unsigned long long>(value);
+        while (p > 0 && digits % 10 == 0) {
+            digits /= 10;
+            --p;
         }
-
-        // 去除小数部分的末尾0
-        int actual_decimal_digits = p;
-        while (actual_decimal_digits > 0 && (decimal_part % 10) == 0) {
-            decimal_part /= 10;
-            actual_decimal_digits--;
+        char buffer[24];
+        const auto length = static_cast<int>(std::to_chars(buffer, buffer + sizeof(buffer), digits).ptr - buffer);
+        if (length > p) {
+            out = std::copy(buffer, buffer + length - p, out);
+            if (p == 0) return out;
+            *out++ = '.';
+            return std::copy(buffer + length - p, buffer + length, out);
         }
+        *out++ = '0';
+        *out++ = '.';
+        out = std::fill_n(out, p - length, '0');
+        return std::copy(buffer, buffer + length, out);
+    }
 
-        // 特殊情况处理：如果整数部分和小数部分都为0
-        if (integer_part == 0 && decimal_part == 0) return "0";
-
-        // 构建字符串
-        std::string result;
-        if (negative) result.push_back('-');
-
-        char buffer[32];
+    /// @brief dtos 的实现, 写入 out (至少 NumberString::CAPACITY 字节), 返回长度
+    /// @details 按 p 位小数四舍五入 (结果精确, 不受二进制误差影响), 再去掉小数部分末尾的0.
+    ///          坐标几乎都是 p 位以内的小数: 若 num 就是最接近某个 p 位小数的 double, 该小数即为舍入结果,
+    ///          直接按整数格式化; 否则 (恰好在两个 p 位小数中间等) 交给指定精度的 std::to_chars.
+    std::size_t format_trimmed(double num, int p, char *out) {
+        char *const last = out + badge::NumberString::CAPACITY;
+        // 超过 double 有效位数的小数位没有意义
+        p = std::clamp(p, 0, 17);
 
-        // 处理整数部分
-        if (integer_part == 0) {
-            if (actual_decimal_digits == 0) result.push_back('0');
-        } else {
-            int int_len = 0;
-            while (integer_part > 0) {
-                buffer[int_len++] = '0' + (integer_part % 10);
-                integer_part /= 10;
-            }
-            std::reverse(buffer, buffer + int_len);
-            result.append(buffer, int_len);
+        const double scaled = num * POW10[p];
+        if (scaled > -SCALED_LIMIT && scaled < SCALED_LIMIT) {
+            const double rounded = std::nearbyint(scaled);
+            if (rounded / POW10[p] == num) return static_cast<std::size_t>(write_scaled(static_cast<long long>(rounded), p, out) - out);
         }
 
-        // 处理小数部分
-        if (actual_decimal_digits > 0) {
-            result.push_back('.');
-            int dec_len = 0;
-            // 从最低位到最高位处理小数部分的每一位
-            for (int i = 0; i < actual_decimal_digits; ++i) {
-                buffer[dec_len++] = '0' + (decimal_part % 10);
-                decimal_part /= 10;
-            }
-            // 反转小数部分
-            std::reverse(buffer, buffer + dec_len);
-            result.append(buffer, dec_len);
+        auto result = std::to_chars(out, last, num, std::chars_format::fixed, p);
+        // 定点格式放不下的极大值, 退化为最短表示
+        if (result.ec != std::errc{}) return static_cast<std::size_t>(std::to_chars(out, last, num).ptr - out);
+        char *end = result.ptr;
+        if (p > 0) {
+            while (end[-1] == '0') --end;
+            if (end[-1] == '.') --end;
         }
+        // 舍入到0的负数输出为 "0" 而不是 "-0"
+        if (end - out == 2 && out[0] == '-' && out[1] == '0') {
+            out[0] = '0';
+            end = out + 1;
+        }
+        return static_cast<std::size_t>(end - out);
+    }
+}// namespace
+namespace badge {
+    std::string dtos(double num, int p) {
+        char buffer[NumberString::CAPACITY];
+        return {buffer, format_trimmed(num, p, buffer)};
+    }
 
-        return result;
+    NumberString::NumberString(double value) noexcept {
+        auto result = std::to_chars(buffer_, buffer_ + CAPACITY, value, std::chars_format::fixed, 6);
+        if (result.ec != std::errc{}) result = std::to_chars(buffer_, buffer_ + CAPACITY, value);
+        length_ = static_cast<std::size_t>(result.ptr - buffer_);
+    }
+    NumberString NumberString::trimmed(double d, int p) noexcept {
+        NumberString s;
+        s.length_ = format_trimmed(d, p, s.buffer_);
+        return s;
     }
 
     std::string toUpperCase(std::string str) {
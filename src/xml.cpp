@@ -1,6 +1,124 @@
 #include "badgecpp/xml.hpp"
+#include "badgecpp/metrics.hpp"
+#include <algorithm>
+#include <array>
+#include <charconv>
 #include <cstddef>
-#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace {
+    /// @brief 需要转义的字符表
+    constexpr auto SPECIAL = []() {
+        std::array<bool, 256> table{};
+        table['&'] = table['<'] = table['>'] = table['"'] = table['\''] = true;
+        return table;
+    }();
+
+    /// @brief 查找下一个需要转义的字符
+    /// @return 指向该字符的指针, 不存在则返回 end
+    const char *find_special(const char *p, const char *end) {
+#ifdef __SSE2__
+        const __m128i amp = _mm_set1_epi8('&');
+        const __m128i lt = _mm_set1_epi8('<');
+        const __m128i gt = _mm_set1_epi8('>');
+        const __m128i quot = _mm_set1_epi8('"');
+        const __m128i apos = _mm_set1_epi8('\'');
+        for (; end - p >= 16; p += 16) {
+            const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+            const __m128i hit = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, amp), _mm_cmpeq_epi8(v, lt)),
+                                             _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, gt), _mm_cmpeq_epi8(v, quot)),
+                                                          _mm_cmpeq_epi8(v, apos)));
+            if (const int mask = _mm_movemask_epi8(hit)) return p + __builtin_ctz(static_cast<unsigned int>(mask));
+        }
+#endif
+        while (p != end && !SPECIAL[static_cast<unsigned char>(*p)]) ++p;
+        return p;
+    }
+
+    /// @brief 转义实体
+    constexpr std::string_view entity(char ch) {
+        switch (ch) {
+                // clang-format off
+            case '&':  return "&amp;";
+            case '<':  return "&lt;";
+            case '>':  return "&gt;";
+            case '"':  return "&quot;";
+            case '\'': return "&apos;";
+            default:   return {};
+                // clang-format on
+        }
+    }
+
+    /// @brief 转义并追加到 out, 不含特殊字符的片段整段复制
+    void escape_xml(std::string &out, std::string_view str) {
+        const char *p = str.data();
+        const char *const end = p + str.size();
+        while (true) {
+            const char *q = find_special(p, end);
+            out.append(p, q - p);
+            if (q == end) break;
+            out += entity(*q);
+            p = q + 1;
+        }
+    }
+
+    /// @brief 将整数追加到 out
+    template<typename String>
+    void append_uint(String &out, unsigned int value) {
+        char buf[16];
+        const auto res = std::to_chars(buf, buf + sizeof(buf), value);
+        out.append(buf, res.ptr - buf);
+    }
+
+    /// @brief 序列化一个节点, Xml 与 pmr::Xml 共用
+    /// @details 内容的第0个备选为子节点 (指针或 shared_ptr), 第1个为文本; 子节点由 render_sub 递归序列化
+    template<typename Attrs, typename Contents, typename RenderSub>
+    void render_node(std::string &out, std::string_view name, const Attrs &attrs, const Contents &contents, bool subEmpty, RenderSub &&render_sub) {
+        const bool hasTag = !name.empty();
+        if (hasTag) {
+            out += '<';
+            out += name;
+            for (const auto &[key, value]: attrs) {
+                out += ' ';
+                out += key;
+                out += "=\"";
+                escape_xml(out, value);
+                out += '"';
+            }
+        }
+        if (subEmpty) {
+            if (hasTag) out += "/>";
+        } else {
+            if (hasTag) out += '>';
+            for (const auto &item: contents) {
+                if (const auto *text = std::get_if<1>(&item)) {
+                    escape_xml(out, *text);
+                } else {
+                    render_sub(std::get<0>(item));
+                }
+            }
+            if (hasTag) {
+                out += "</";
+                out += name;
+                out += '>';
+            }
+        }
+    }
+
+    /// @brief 转义后的长度
+    size_t escaped_size(std::string_view str) {
+        size_t size = str.size();
+        const char *p = str.data();
+        const char *const end = p + str.size();
+        while ((p = find_special(p, end)) != end) size += entity(*p++).size() - 1;
+        return size;
+    }
+}// namespace
 
 namespace badge {
     Xml::Xml(std::string name, Attrs attr, Contents content) : name_(std::move(name)), attr_(std::move(attr)), content_(std::move(content)) {}
@@ -13,33 +131,46 @@ namespace badge {
         return *this;
     }
     void Xml::render(std::ostream &os) const {
+        std::string out;
+        render(out);
+        os.write(out.data(), static_cast<std::streamsize>(out.size()));
+    }
+    void Xml::render(std::string &out) const {
+        BADGECPP_METRICS_PHASE(XML_RENDER);
+        [[maybe_unused]] const size_t begin = out.size();
+        out.reserve(out.size() + renderSize());
+        render_to(out);
+        BADGECPP_METRICS_OUTPUT(std::string_view{out}.substr(begin));
+    }
+    std::string Xml::render() const {
+        std::string out;
+        render(out);
+        return out;
+    }
+    void Xml::render_to(std::string &out) const {
+        render_node(out, name_, attr_, content_, isSubEmpty(), [&out](const auto &sub) { sub->render_to(out); });
+    }
+    size_t Xml::renderSize() const {
+        size_t size = 0;
         const bool hasTag = !name_.empty();
         if (hasTag) {
-            os << '<' << name_;
-            for (const auto &[key, value]: attr_) {
-                os << ' ' << key << "=\"";
-                escape_xml(os, value);
-                os << '"';
-            }
+            size += 1 + name_.size();// <name
+            for (const auto &[key, value]: attr_)
+                size += 1 + key.size() + 2 + escaped_size(value) + 1;// ␣key="value"
         }
         if (isSubEmpty()) {
-            if (hasTag) os << "/>";
+            if (hasTag) size += 2;// />
         } else {
-            if (hasTag) os << '>';
-            for (size_t i = 0; i < content_.size(); ++i) {
-                if (std::holds_alternative<std::string>(content_[i])) {
-                    escape_xml(os, std::get<std::string>(content_[i]));
+            if (hasTag) size += 1 + 2 + name_.size() + 1;// > ... </name>
+            for (const auto &item: content_) {
+                if (const auto *text = std::get_if<std::string>(&item)) {
+                    size += escaped_size(*text);
                 } else {
-                    std::get<0>(content_[i])->render(os);
+                    size += std::get<0>(item)->renderSize();
                 }
             }
-            if (hasTag) os << "</" << name_ << '>';
         }
-    }
-    std::string Xml::render() const {
-        std::ostringstream oss;
-        render(oss);
-        return oss.str();
+        return size;
     }
 
     bool Xml::isEmpty() const {
@@ -58,18 +189,285 @@ namespace badge {
         return true;
     }
 
-    void Xml::escape_xml(std::ostream &os, const std::string &str) {
-        for (const char &ch: str) {
-            switch (ch) {
-                    // clang-format off
-                    case '&':  os << "&amp;";  break;
-                    case '<':  os << "&lt;";   break;
-                    case '>':  os << "&gt;";   break;
-                    case '"':  os << "&quot;"; break;
-                    case '\'': os << "&apos;"; break;
-                    default:   os << ch;       break;
-                    // clang-format on
+    XmlTemplate::XmlTemplate(std::string_view pattern) : pattern_(pattern) {
+        const auto fail = [&](const char *msg) {
+            throw std::invalid_argument(std::string{"[badgecpp::XmlTemplate] "} + msg + ": " + pattern_);
+        };
+        if (pattern_.find('&') != std::string::npos) fail("Entities are not supported");
+
+        /// @brief 将 [begin, end) 按空洞切分
+        const auto split = [&](size_t begin, size_t end) {
+            std::vector<Piece> pieces;
+            size_t literal = begin;
+            for (size_t i = begin; i < end; ++i) {
+                if (pattern_[i] != '$') continue;
+                if (i + 1 >= end || pattern_[i + 1] < '0' || pattern_[i + 1] > '9') fail("Invalid hole");
+                if (i > literal) pieces.push_back({literal, i - literal, -1});
+                const int hole = pattern_[i + 1] - '0';
+                pieces.push_back({0, 0, hole});
+                holes_ = std::max(holes_, hole + 1);
+                literal = ++i + 1;
+            }
+            if (end > literal) pieces.push_back({literal, end - literal, -1});
+            return pieces;
+        };
+        pieces_ = split(0, pattern_.size());
+
+        const size_t n = pattern_.size();
+        size_t i = 0;
+        while (i < n) {
+            if (pattern_[i] != '<') {
+                // text
+                const size_t end = std::min(pattern_.find('<', i), n);
+                auto value = split(i, end);
+                if (std::all_of(value.begin(), value.end(), [](const Piece &p) { return p.hole >= 0; }))
+                    fail("Text holes must be accompanied by literal text");
+                ops_.push_back({Op::TEXT, 0, 0, std::move(value)});
+                i = end;
+            } else if (i + 1 < n && pattern_[i + 1] == '/') {
+                // </name>
+                if (ops_.empty()) fail("Pattern must not start with a closing tag");
+                if (ops_.back().kind == Op::OPEN || ops_.back().kind == Op::ATTR) fail("Empty elements must be self-closing");
+                const size_t end = pattern_.find('>', i);
+                if (end == std::string::npos) fail("Unterminated closing tag");
+                ops_.push_back({Op::CLOSE, i + 2, end - i - 2, {}});
+                i = end + 1;
+            } else {
+                // <name attr="value" ...> or <name .../> or <name ... (open at end)
+                const size_t name = i + 1;
+                i = std::min(pattern_.find_first_of(" />", name), n);
+                const size_t name_length = i - name;
+                if (name_length == 0) fail("Missing element name");
+                ops_.push_back({Op::OPEN, name, name_length, {}});
+                while (true) {
+                    while (i < n && pattern_[i] == ' ') ++i;
+                    if (i >= n) {
+                        open_at_end_ = true;
+                        break;
+                    }
+                    if (pattern_[i] == '>') {
+                        ++i;
+                        break;
+                    }
+                    if (pattern_.compare(i, 2, "/>") == 0) {
+                        ops_.push_back({Op::CLOSE, name, name_length, {}});
+                        i += 2;
+                        break;
+                    }
+                    const size_t eq = pattern_.find("=\"", i);
+                    if (eq == std::string::npos) fail("Invalid attribute");
+                    const size_t end = pattern_.find('"', eq + 2);
+                    if (end == std::string::npos) fail("Unterminated attribute value");
+                    ops_.push_back({Op::ATTR, i, eq - i, split(eq + 2, end)});
+                    i = end + 1;
+                }
+            }
+        }
+    }
+    std::string_view XmlTemplate::assemble(std::pmr::string &buf, const std::vector<Piece> &value, std::initializer_list<Value> values) const {
+        if (value.size() == 1) {
+            const auto &piece = value.front();
+            if (piece.hole < 0) return {pattern_.data() + piece.offset, piece.length};
+            if (const auto *str = std::get_if<std::string_view>(values.begin() + piece.hole)) return *str;
+        }
+        buf.clear();
+        for (const auto &piece: value) {
+            if (piece.hole < 0) {
+                buf.append(pattern_, piece.offset, piece.length);
+            } else if (const auto *str = std::get_if<std::string_view>(values.begin() + piece.hole)) {
+                buf += *str;
+            } else {
+                append_uint(buf, std::get<unsigned int>(values.begin()[piece.hole]));
+            }
+        }
+        return buf;
+    }
+    void XmlTemplate::check(std::initializer_list<Value> values) const {
+        if (static_cast<int>(values.size()) < holes_)
+            throw std::invalid_argument("[badgecpp::XmlTemplate] Need " + std::to_string(holes_) + " values, got " + std::to_string(values.size()));
+    }
+
+    XmlWriter &XmlWriter::open(std::string_view name) {
+        flush_pending();
+        out_ += '<';
+        out_ += name;
+        pending_ = true;
+        return *this;
+    }
+    XmlWriter &XmlWriter::attr(std::string_view key, std::string_view value) {
+        out_ += ' ';
+        out_ += key;
+        out_ += "=\"";
+        escape_xml(out_, value);
+        out_ += '"';
+        return *this;
+    }
+    XmlWriter &XmlWriter::text(std::string_view text) {
+        if (text.empty()) return *this;
+        flush_pending();
+        escape_xml(out_, text);
+        return *this;
+    }
+    XmlWriter &XmlWriter::close(std::string_view name) {
+        if (pending_) {
+            out_ += "/>";
+            pending_ = false;
+        } else {
+            out_ += "</";
+            out_ += name;
+            out_ += '>';
+        }
+        return *this;
+    }
+    XmlWriter &XmlWriter::fill(const XmlTemplate &tpl, std::initializer_list<XmlTemplate::Value> values) {
+        tpl.check(values);
+        flush_pending();
+        for (const auto &piece: tpl.pieces_) {
+            if (piece.hole < 0) {
+                out_.append(tpl.pattern_, piece.offset, piece.length);
+            } else if (const auto *str = std::get_if<std::string_view>(values.begin() + piece.hole)) {
+                escape_xml(out_, *str);
+            } else {
+                append_uint(out_, std::get<unsigned int>(values.begin()[piece.hole]));
             }
         }
+        pending_ = tpl.open_at_end_;
+        return *this;
+    }
+    void XmlWriter::flush_pending() {
+        if (pending_) {
+            out_ += '>';
+            pending_ = false;
+        }
+    }
+
+    XmlBuilder &XmlBuilder::open(std::string_view name) {
+        if (depth_ == frames_.size()) {
+            auto &frame = frames_.emplace_back();
+            frame.attrs.reserve(FRAME_RESERVE);
+            frame.contents.reserve(FRAME_RESERVE);
+        }
+        frames_[depth_++].name.assign(name);
+        return *this;
+    }
+    XmlBuilder &XmlBuilder::attr(std::string_view key, std::string_view value) {
+        frames_[depth_ - 1].attrs.emplace_back(key, value);
+        return *this;
     }
+    XmlBuilder &XmlBuilder::text(std::string_view text) {
+        if (!text.empty()) frames_[depth_ - 1].contents.emplace_back(std::in_place_type<std::string>, text);
+        return *this;
+    }
+    XmlBuilder &XmlBuilder::close([[maybe_unused]] std::string_view name) {
+        auto &frame = frames_[--depth_];
+        Xml node{frame.name,
+                 Xml::Attrs(std::make_move_iterator(frame.attrs.begin()), std::make_move_iterator(frame.attrs.end())),
+                 Xml::Contents(std::make_move_iterator(frame.contents.begin()), std::make_move_iterator(frame.contents.end()))};
+        frame.attrs.clear();
+        frame.contents.clear();
+        if (depth_ == 0) root_ = std::move(node);
+        else frames_[depth_ - 1].contents.emplace_back(std::make_shared<Xml>(std::move(node)));
+        return *this;
+    }
+    XmlBuilder &XmlBuilder::fill(const XmlTemplate &tpl, std::initializer_list<XmlTemplate::Value> values) {
+        tpl.replay(*this, values);
+        return *this;
+    }
+
+    namespace pmr {
+        Xml::Xml(allocator_type alloc) : name_(alloc), attr_(alloc), content_(alloc) {}
+        Xml::Xml(std::string_view name, allocator_type alloc) : name_(name, alloc), attr_(alloc), content_(alloc) {}
+        Xml::Xml(Xml &&other) noexcept : name_(std::move(other.name_)), attr_(std::move(other.attr_)), content_(std::move(other.content_)) {
+            other.content_.clear();
+        }
+        Xml::~Xml() {
+            std::pmr::polymorphic_allocator<Xml> alloc{get_allocator()};
+            for (auto &item: content_) {
+                if (auto *sub = std::get_if<Xml *>(&item)) {
+                    (*sub)->~Xml();
+                    alloc.deallocate(*sub, 1);
+                }
+            }
+        }
+        Xml &Xml::setName(std::string_view name) {
+            name_.assign(name);
+            return *this;
+        }
+        Xml &Xml::addAttr(std::string_view key, std::string_view value) {
+            attr_.emplace_back(key, value);
+            return *this;
+        }
+        Xml &Xml::addContent(std::string_view text) {
+            content_.emplace_back(std::in_place_type<std::pmr::string>, text, get_allocator());
+            return *this;
+        }
+        Xml &Xml::addNode(std::string_view name) {
+            std::pmr::polymorphic_allocator<Xml> alloc{get_allocator()};
+            Xml *sub = alloc.allocate(1);
+            ::new (sub) Xml(name, get_allocator());
+            content_.emplace_back(std::in_place_type<Xml *>, sub);
+            return *sub;
+        }
+
+        void Xml::render(std::ostream &os) const {
+            std::string out;
+            render(out);
+            os << out;
+        }
+        void Xml::render(std::string &out) const {
+            BADGECPP_METRICS_PHASE(XML_RENDER);
+            [[maybe_unused]] const size_t begin = out.size();
+            render_to(out);
+            BADGECPP_METRICS_OUTPUT(std::string_view{out}.substr(begin));
+        }
+        void Xml::render_to(std::string &out) const {
+            render_node(out, name_, attr_, content_, isSubEmpty(), [&out](const auto &sub) { sub->render_to(out); });
+        }
+        std::string Xml::render() const {
+            std::string out;
+            render(out);
+            return out;
+        }
+
+        bool Xml::isEmpty() const {
+            if (!name_.empty()) return false;
+            return isSubEmpty();
+        }
+        bool Xml::isSubEmpty() const {
+            for (const auto &item: content_) {
+                if (const auto *text = std::get_if<std::pmr::string>(&item)) {
+                    if (!text->empty()) return false;
+                } else {
+                    if (!std::get<Xml *>(item)->isEmpty()) return false;
+                }
+            }
+            return true;
+        }
+
+        XmlBuilder &XmlBuilder::open(std::string_view name) {
+            if (stack_.empty()) {
+                root_.setName(name);
+                stack_.push_back(&root_);
+            } else {
+                stack_.push_back(&stack_.back()->addNode(name));
+            }
+            return *this;
+        }
+        XmlBuilder &XmlBuilder::attr(std::string_view key, std::string_view value) {
+            stack_.back()->addAttr(key, value);
+            return *this;
+        }
+        XmlBuilder &XmlBuilder::text(std::string_view text) {
+            if (!text.empty()) stack_.back()->addContent(text);
+            return *this;
+        }
+        XmlBuilder &XmlBuilder::close([[maybe_unused]] std::string_view name) {
+            stack_.pop_back();
+            return *this;
+        }
+        XmlBuilder &XmlBuilder::fill(const XmlTemplate &tpl, std::initializer_list<XmlTemplate::Value> values) {
+            tpl.replay(*this, values, root_.get_allocator().resource());
+            return *this;
+        }
+    }// namespace pmr
 }// namespace badge
\ No newline at end of file
@@ -1,44 +1,178 @@
-import json
+#!/usr/bin/python3
+# 将 assets/badgecpp/fonts/*.json 编译为 constexpr 查找表 (assets/build/include/badgecpp/fonts.h)
+# 生成的表与 Font::build 在运行时构建的结构完全一致, 加载时无需解析, 也不分配内存
+import bisect
 import os
+import re
+import struct
+import sys
 
-snippet = """#include "badgecpp/font.hpp"
-namespace {
-    [[maybe_unused]] bool _ = ([]() {
-        badge::Fonts::createFont("%s", badge::Font{
-                                                                // clang-format off
-            {
+BASE_DIR = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+FONT_DIR = os.path.join(BASE_DIR, "assets", "badgecpp", "fonts")
+OUTPUT_FILE = os.path.join(BASE_DIR, "assets", "build", "include", "badgecpp", "fonts.h")
+PRINT_PREFIX = "[font-maker]"
+
+GUESS_CHAR = ord('m')
+UNKNOWN = -1.0
+NO_INDEX = 0xFFFF
+
+FONT_NAME = re.compile(r"^([A-Za-z0-9_]+)-(\d+)px-([A-Za-z0-9_]+)$")
+RANGE = re.compile(r"\[\s*(-?\d+)\s*,\s*(-?\d+)\s*,\s*(-?)(\d*)(?:\.(\d+))?\s*\]")
+
+header = """// THIS IS AUTOGENERATED FILE, DO NOT MODIFY (tools/font_maker.py)
+#ifndef BADGECPP_FONTS_H
+#define BADGECPP_FONTS_H
+#include "badgecpp/font.hpp"
+#include <cstdint>
+#include <iterator>
+#include <string_view>
+namespace badge::_assets::fonts {
+"""
+footer = """
+    /// @brief 内置字体
+    struct BuiltinFont {
+        std::string_view name;
+        Font font;
+    };
+
+    /// @brief 由 constexpr 构造函数常量初始化, 不参与动态初始化, 也不分配内存
+    const BuiltinFont BUILTIN_FONTS[] = {
 %s
-                    },
-                                                                // clang-format on
-                                                                %d});
-        return true;
-    })();
-}
+    };
+}// namespace badge::_assets::fonts
+#endif// BADGECPP_FONTS_H
 """
-FONT_DIR = os.path.join(os.path.dirname(os.path.dirname(os.path.abspath(__file__))), "src", "fonts")
-assert os.path.isdir(FONT_DIR), "Font directory not found: " + FONT_DIR
 
 
-def make_font_cpp(font_name: str, font_file: str, font_size: int):
-    font_cpp_file = os.path.join(FONT_DIR, font_name + ".cpp")
-    assert not os.path.isfile(font_cpp_file), "Font cpp file already exists: " + font_cpp_file
+def read_double(sign: str, integer: str, fraction: "str|None") -> float:
+    """与 Font::createByJsonReader 中的 read_double 逐步一致, 保证得到同一个 double"""
+    x = 0.0
+    for c in integer:
+        x = (x * 10.0) + (ord(c) - ord('0'))
+    if fraction is not None:
+        place = 1.0
+        for c in fraction:
+            place /= 10.0
+            x += (ord(c) - ord('0')) * place
+    return x * (-1.0 if sign == '-' else 1.0)
+
+
+def load_ranges(font_file: str) -> "list[tuple[int,int,float]]":
     with open(font_file, 'r') as f:
-        font_data: "list[tuple[int,int,float]]" = json.load(f)
-    font_data_str = ",".join(f"{{{x[0]},{x[1]},{x[2]}}}" for x in font_data)
-    code = snippet % (font_name, font_data_str, font_size)
+        text = f.read()
+    ranges = [(int(m.group(1)), int(m.group(2)), read_double(m.group(3), m.group(4), m.group(5)))
+              for m in RANGE.finditer(text)]
+    assert ranges, "Empty font file: " + font_file
+    assert len(ranges) == text.count('[') - 1, "Malformed font file: " + font_file
+    return ranges
 
-    with open(font_cpp_file, 'w') as f:
-        f.write(code)
-    print("Generated font cpp file: " + font_cpp_file)
 
+def is_control_char(c: int) -> bool:
+    return c <= 31 or c == 127
 
-if __name__ == '__main__':
-    import argparse
 
-    parser = argparse.ArgumentParser(description='Generate font cpp files from json files.')
-    parser.add_argument('font_name', type=str, help='Name of the font.')
-    parser.add_argument('font_file', type=str, help='Path to the json file containing the font data.')
-    parser.add_argument('font_size', type=int, help='Size of the font.')
-    args = parser.parse_args()
+def build(ranges: "list[tuple[int,int,float]]"):
+    """Font::build 的 Python 版本"""
+    lower = [r[0] for r in ranges]
+    upper = [r[1] for r in ranges]
+    width = [r[2] for r in ranges]
+
+    def lookup_range(c: int) -> float:
+        i = bisect.bisect_left(upper, c)
+        if i < len(upper) and lower[i] <= c:
+            return width[i]
+        return UNKNOWN
+
+    latin1 = [0.0 if is_control_char(c) else lookup_range(c) for c in range(0x100)]
+
+    bmp_pages = [NO_INDEX] * 0x100
+    bmp_cells: "list[int]" = []
+    values: "list[float]" = []
+    value_index: "dict[float,int]" = {}
+    for lo, up, _ in ranges:
+        if lo > 0xFFFF:
+            continue
+        for page in range(max(lo, 0x100) >> 8, (min(up, 0xFFFF) >> 8) + 1):
+            if bmp_pages[page] != NO_INDEX:
+                continue
+            bmp_pages[page] = len(bmp_cells) >> 8
+            cells = [NO_INDEX] * 0x100
+            for low in range(0x100):
+                w = lookup_range((page << 8) | low)
+                if w < 0:
+                    continue
+                if w not in value_index:
+                    assert len(values) < NO_INDEX, "Too many distinct widths"
+                    value_index[w] = len(values)
+                    values.append(w)
+                cells[low] = value_index[w]
+            bmp_cells += cells
+
+    em_width = latin1[GUESS_CHAR]
+    assert em_width > 0, "emWidth must be positive"
+    return latin1, bmp_pages, bmp_cells, values, lower, upper, width, em_width
+
 
-    make_font_cpp(args.font_name, args.font_file, args.font_size)
+def fmt_double(x: float) -> str:
+    s = repr(x)
+    assert float(s) == x and struct.pack('<d', float(s)) == struct.pack('<d', x)
+    return s
+
+
+def array(type_name: str, name: str, items: "list[str]", per_line: int = 16) -> str:
+    if not items:
+        items = ["0"]  # C++ 不允许零长数组, 占位项不会被访问
+    lines = [",".join(items[i:i + per_line]) for i in range(0, len(items), per_line)]
+    return "        constexpr %s %s[] = {\n            %s};\n" % (type_name, name, ",\n            ".join(lines))
+
+
+def make_font(font_name: str, font_file: str) -> "tuple[str,str]":
+    m = FONT_NAME.match(font_name)
+    assert m, "Invalid font name: " + font_name
+    size = int(m.group(2))
+    ident = re.sub(r"[^A-Za-z0-9]", "_", font_name)
+
+    latin1, bmp_pages, bmp_cells, values, lower, upper, width, em_width = build(load_ranges(font_file))
+
+    code = "    namespace %s {\n" % ident
+    code += array("double", "latin1", [fmt_double(x) for x in latin1], 8)
+    code += array("uint16_t", "bmp_pages", [str(x) for x in bmp_pages])
+    code += array("uint16_t", "bmp_cells", [str(x) for x in bmp_cells])
+    code += array("double", "values", [fmt_double(x) for x in values], 8)
+    code += array("char32_t", "range_lower", [str(x) for x in lower])
+    code += array("char32_t", "range_upper", [str(x) for x in upper])
+    code += array("double", "range_width", [fmt_double(x) for x in width], 8)
+    code += "    }// namespace %s\n" % ident
+
+    entry = ('        {"%s", Font{{%s::latin1, %s::bmp_pages, %s::bmp_cells, %s::values, '
+             '%s::range_lower, %s::range_upper, %s::range_width, std::size(%s::range_width)}, %d, %s}},'
+             % (font_name, *([ident] * 8), size, fmt_double(em_width)))
+    return code, entry
+
+
+def main() -> int:
+    if not os.path.isdir(FONT_DIR):
+        print("%s Font directory not found: %s" % (PRINT_PREFIX, FONT_DIR))
+        return -1
+    codes, entries = [], []
+    for file in sorted(os.listdir(FONT_DIR)):
+        if not file.endswith(".json"):
+            continue
+        code, entry = make_font(file[:-len(".json")], os.path.join(FONT_DIR, file))
+        codes.append(code)
+        entries.append(entry)
+    content = header + "\n".join(codes) + footer % "\n".join(entries)
+
+    os.makedirs(os.path.dirname(OUTPUT_FILE), exist_ok=True)
+    if os.path.isfile(OUTPUT_FILE):
+        with open(OUTPUT_FILE, 'r') as f:
+            if f.read() == content:
+                return 0  # 内容未变, 不触发重新编译
+    with open(OUTPUT_FILE, 'w') as f:
+        f.write(content)
+    print("%s Generated %d fonts: %s" % (PRINT_PREFIX, len(entries), OUTPUT_FILE))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -1,5 +1,6 @@
 import re
 import os
+import struct
 import unicodedata
 from typing import Optional, TypedDict
 import xml.etree.ElementTree as ET
@@ -92,39 +93,175 @@ def cvt(icons: "list[Icon]") -> "list[Icon]":
         # 如果 SVG 文件在子目录中，请相应调整
         relative_path = f"{slug}.svg"
 
+        icon['slug'] = slug
         icon['svg'] = relative_path
     return icons
 
 
+# 二进制索引格式 (全部为小端 uint32, 与 src/icons.cpp 保持一致):
+#   header:  magic 'BIDX', version, count, strings_size, table_count, node_count, node_icon_count
+#   tables:  table_count 个 {keys, buckets}, 依次为 标题, slug, 小写标题
+#   records: count 个 {data_offset, data_length, title_offset, title_length,
+#                      slug_offset, slug_length, hex_offset, hex_length}, 按标题(字节序)排序
+#   每张表:  disp[buckets], slots[keys]
+#   nodes:   node_count 个 {label_offset, label_length, first_child, child_count, icons_begin, icons_count}
+#   node_icons: node_icon_count 个图标下标
+#   strings: 所有标题/slug/颜色/trie边标签, 不以 '\0' 结尾
+# 哈希表为最小完美哈希 (hash and displace):
+#   bucket = hash(key, 0) % buckets, slot = hash(key, disp[bucket]) % keys, slots[slot] 为图标下标
+# 查找时仍需比较 key, 以排除不在集合中的字符串.
+# trie 为压缩前缀树 (radix trie), 键为小写标题与 slug; 节点按层序排列, 同一节点的子节点连续且按标签排序,
+# 根节点为 nodes[0].
+INDEX_MAGIC = 0x58444942  # 'BIDX'
+INDEX_VERSION = 2
+TABLE_TITLE = 0
+TABLE_SLUG = 1
+TABLE_TITLE_LOWER = 2
+
+
+def icon_hash(key: bytes, seed: int) -> int:
+    """FNV-1a + murmur3 fmix32, 与 src/icons.cpp 中的 icon_hash 一致"""
+    h = (0x811C9DC5 ^ seed) & 0xFFFFFFFF
+    for b in key:
+        h = ((h ^ b) * 0x01000193) & 0xFFFFFFFF
+    h ^= h >> 16
+    h = (h * 0x85EBCA6B) & 0xFFFFFFFF
+    h ^= h >> 13
+    h = (h * 0xC2B2AE35) & 0xFFFFFFFF
+    h ^= h >> 16
+    return h
+
+
+def build_mph(keys: "list[tuple[bytes, int]]") -> "tuple[list[int], list[int]]":
+    """构建最小完美哈希表, keys 为 (key, 图标下标), key 必须互不相同"""
+    n = len(keys)
+    if n == 0:
+        return [0], []
+    buckets: "list[list[tuple[bytes, int]]]" = [[] for _ in range((n + 1) // 2)]
+    for key in keys:
+        buckets[icon_hash(key[0], 0) % len(buckets)].append(key)
+
+    disp = [0] * len(buckets)
+    slots = [-1] * n
+    for b in sorted(range(len(buckets)), key=lambda b: -len(buckets[b])):
+        if not buckets[b]:
+            break
+        d = 1
+        while True:
+            positions = [icon_hash(key, d) % n for key, _ in buckets[b]]
+            if len(set(positions)) == len(positions) and all(slots[p] < 0 for p in positions):
+                break
+            d += 1
+        disp[b] = d
+        for p, (_, index) in zip(positions, buckets[b]):
+            slots[p] = index
+    return disp, slots
+
+
+def ascii_lower(key: bytes) -> bytes:
+    """只折叠 ASCII 字母, 与 src/icons.cpp 中的 ascii_lower 一致"""
+    return bytes(b + 32 if 65 <= b <= 90 else b for b in key)
+
+
+def build_trie(keys: "list[tuple[bytes, int]]", add_string) -> "tuple[list[tuple[int,...]], list[int]]":
+    """构建压缩前缀树, 返回 (nodes, node_icons)"""
+    root: dict = {'children': {}, 'icons': []}
+    for key, index in keys:
+        node = root
+        for b in key:
+            node = node['children'].setdefault(b, {'children': {}, 'icons': []})
+        if index not in node['icons']:
+            node['icons'].append(index)
+
+    def compress(label: bytes, node: dict) -> "tuple[bytes, dict]":
+        while len(node['children']) == 1 and not node['icons']:
+            (b, child), = node['children'].items()
+            label += bytes([b])
+            node = child
+        return label, node
+
+    nodes: "list[tuple[int,...]]" = []
+    node_icons: "list[int]" = []
+    queue = [(b'', root)]
+    nodes.append(())
+    head = 0
+    while head < len(queue):
+        label, node = queue[head]
+        children = [compress(bytes([b]), child) for b, child in sorted(node['children'].items())]
+        first_child = len(queue)
+        queue += children
+        nodes += [()] * len(children)
+        icons = sorted(node['icons'])
+        nodes[head] = (*add_string(label), first_child, len(children), len(node_icons), len(icons))
+        node_icons += icons
+        head += 1
+    return nodes, node_icons
+
+
 def index_maker(icons: "list[Icon]", icon_folder: str, index_output: str, data_output: str):
     os.makedirs(os.path.dirname(index_output), exist_ok=True)
     os.makedirs(os.path.dirname(data_output), exist_ok=True)
 
-    offset = 0
+    icons = [icon for icon in icons if icon.get('title') and icon.get('svg')]
+    icons.sort(key=lambda icon: icon['title'].encode('utf-8'))
 
-    with open(index_output, 'w', encoding='utf-8') as index_f:
-        with open(data_output, 'wb') as data_f:
-            for icon in icons:
-                title = icon.get('title')
-                svg = icon.get('svg')
-                hex = icon.get('hex', "")
-                if not title or not svg:
-                    continue
-                icon_path = os.path.join(icon_folder, svg)
-
-                assert os.path.exists(icon_path), f"Icon file {icon_path} not found: {title}"
-
-                with open(icon_path, 'rb') as svg_f:
-                    svg_content = svg_f.read()
-                    svg_content = cvt_svg(title, svg_content.decode('utf-8')).encode('utf-8')
-                length = len(svg_content)
-                data_f.write(svg_content)
-
-                assert '\t' not in hex, f"Invalid hex code: {hex}"
-                assert '\n' not in title, f"Invalid title: {title}"
-
-                index_f.write(f"{offset}\t{length}\t{hex}\t{title}\n")
-                offset += length
+    strings = bytearray()
+
+    def add_string(s: "str|bytes") -> "tuple[int,int]":
+        data = s.encode('utf-8') if isinstance(s, str) else s
+        strings.extend(data)
+        return len(strings) - len(data), len(data)
+
+    offset = 0
+    records: "list[tuple[int,...]]" = []
+    titles: "dict[bytes,int]" = {}
+    slugs: "dict[bytes,int]" = {}
+    lower_titles: "dict[bytes,int]" = {}
+    with open(data_output, 'wb') as data_f:
+        for index, icon in enumerate(icons):
+            title = icon['title']
+            slug = icon.get('slug') or ''
+            hex = icon.get('hex', "")
+            icon_path = os.path.join(icon_folder, icon['svg'])
+
+            assert os.path.exists(icon_path), f"Icon file {icon_path} not found: {title}"
+
+            with open(icon_path, 'rb') as svg_f:
+                svg_content = svg_f.read()
+                svg_content = cvt_svg(title, svg_content.decode('utf-8')).encode('utf-8')
+            length = len(svg_content)
+            data_f.write(svg_content)
+
+            # 重复的标题/slug 以先出现者为准
+            titles.setdefault(title.encode('utf-8'), index)
+            lower_titles.setdefault(ascii_lower(title.encode('utf-8')), index)
+            if slug:
+                slugs.setdefault(slug.encode('utf-8'), index)
+
+            records.append((offset, length, *add_string(title), *add_string(slug), *add_string(hex)))
+            offset += length
+
+    tables = [build_mph(list(titles.items())), build_mph(list(slugs.items())), build_mph(list(lower_titles.items()))]
+    trie_keys = [(ascii_lower(key), index) for key, index in titles.items()] + list(slugs.items())
+    nodes, node_icons = build_trie(sorted(trie_keys, key=lambda k: k[1]), add_string)
+
+    with open(index_output, 'wb') as index_f:
+        def u32(*values: int):
+            index_f.write(struct.pack(f"<{len(values)}I", *values))
+
+        u32(INDEX_MAGIC, INDEX_VERSION, len(records), len(strings), len(tables), len(nodes), len(node_icons))
+        for disp, slots in tables:
+            u32(len(slots), len(disp))
+        for record in records:
+            u32(*record)
+        for disp, slots in tables:
+            u32(*disp)
+            u32(*slots)
+        for node in nodes:
+            u32(*node)
+        if node_icons:
+            u32(*node_icons)
+        index_f.write(strings)
 
 
 if __name__ == "__main__":